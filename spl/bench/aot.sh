@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Compares interpreted and ahead-of-time compiled (plang -emit-cpp) execution of the sample scripts,
+# each scaled up by concatenating it with itself. Run from the spl directory: bash bench/aot.sh [copies]
+
+copies=${1:-200}
+scripts="sample/script1.spl sample/script2.spl" # the samples that open and close their own sessions
+flags="-std=c++17 -O2 -I include"
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+for src in src/*.cpp; do # everything is compiled once, and shared by plang and the generated programs
+	g++ -c "$src" $flags -o "$work/$(basename "${src%.cpp}").o" || exit 1
+done
+runtime=$(ls "$work"/*.o | grep -v "/main.o")
+g++ "$work"/*.o -o "$work/plang"
+
+TIMEFORMAT="%R s"
+
+for script in $scripts; do
+	scaled="$work/$(basename "$script")"
+	for ((i = 0; i < copies; ++i)); do cat "$script"; echo; done > "$scaled"
+
+	"$work/plang" -emit-cpp "$scaled" > /dev/null
+	g++ "${scaled%.spl}.cpp" $runtime $flags -o "${scaled%.spl}.aot" || exit 1
+
+	echo "$script x $copies"
+	printf "  interpreted: "; { time "$work/plang" -norepl "$scaled" > /dev/null; } 2>&1
+	printf "  compiled:    "; { time "${scaled%.spl}.aot" > /dev/null; } 2>&1
+done
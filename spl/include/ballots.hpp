@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Defines the ballot boxes that BALLOT statements are cast into
+// Every ballot's preferences (the IDs of the orders on it, most preferred first) are stored end to end in one array,
+// with a second array marking where each ballot starts, so a ballot costs four bytes per order on it plus four more,
+// and tallying reads the whole box in one sweep
+// Ballots hold IDs rather than slots, so removing an order leaves them be; it's skipped when they're tallied instead
+
+enum class Tally // The ways a ranking can be worked out from ballots
+{
+	RUNOFF, // Instant runoff over the ranked ballots: the order with the fewest first preferences is eliminated, round after round
+	BORDA, // Borda count over the ranked ballots: of m orders on a ballot, the first gets m points, the second m - 1, and so on
+	APPROVAL // Approval voting: each approval ballot gives a point to every order on it
+};
+
+class BallotBox
+{
+public:
+	void cast(const std::vector<int>& ids); // Adds a ballot listing these order IDs
+	void uncast(); // Takes the latest ballot back out (for undoing it)
+	void clear();
+
+	std::size_t size() const; // The number of ballots
+	std::size_t entries() const; // The number of preferences on all of them together
+	const int* begin(std::size_t ballot) const; // The preferences on a ballot run from begin(ballot) up to end(ballot)
+	const int* end(std::size_t ballot) const;
+
+private:
+	std::vector<int> prefs;
+	std::vector<std::uint32_t> starts{0}; // Ballot b runs from prefs[starts[b]] up to prefs[starts[b + 1]]
+};
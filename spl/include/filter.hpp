@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+#include "pizza.hpp"
+#include "symbols.hpp"
+#include "slotset.hpp"
+
+// Defines the filters that WHERE clauses are compiled into
+// A filter is kept in disjunctive normal form: it matches an order if any one of its conjuncts does, and each conjunct
+// is a few masks and bounds that are tested all at once, rather than a tree of conditions to walk
+// The conditions on the pizza are tested once per pizza in the session's pool rather than once per order,
+// so the pass over the orders themselves only reads the hot columns
+
+class OrderSession;
+
+struct Conjunct
+{
+	ToppingMask all{}; // Toppings the pizza must have every one of
+	ToppingMask none{}; // Toppings it must have none of
+	bool meat = false; // Whether it must have some meat (i.e. not be vegetarian)
+	std::uint8_t crusts = 0xFF; // The crusts it may have, as a bit for each Crust (and likewise for sauces and cheeses)
+	std::uint8_t sauces = 0xFF;
+	std::uint8_t cheeses = 0xFF;
+	std::int64_t min_votes = INT64_MIN; // (wider than a tally, so that VOTES > n can't overflow)
+	std::int64_t max_votes = INT64_MAX;
+	std::optional<Symbol> name; // The name the order must have, if it must have one
+	std::vector<Symbol> not_names; // Names it mustn't have
+	bool never = false; // Whether its conditions contradict each other in a way the rest can't show (e.g. two different names)
+
+	bool fits(const Pizza& p) const; // Whether p meets every condition on the pizza
+	bool onlyPizza() const; // Whether there are no conditions besides those on the pizza
+	bool satisfiable() const;
+};
+
+Conjunct operator&(const Conjunct& c1, const Conjunct& c2); // Meets the conditions of both
+
+struct Filter
+{
+	std::vector<Conjunct> conjuncts; // Matches an order if any of these do (so a filter without any matches nothing)
+
+	static constexpr std::size_t maxConjuncts = 64; // (a pizza's conjuncts are tracked as the bits of a single word)
+
+	bool onVotes() const; // Whether any conjunct has a condition on the votes (which an approximate session can't test)
+	bool matches(const OrderSession& os, std::size_t slot) const;
+	SlotSet select(const OrderSession& os) const; // Every live slot that matches
+};
+
+Filter operator&&(const Filter& f1, const Filter& f2); // These keep the result in normal form,
+Filter operator||(const Filter& f1, const Filter& f2); // dropping any conjuncts that can't be met
@@ -0,0 +1,18 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "pizza.hpp"
+
+// Defines the totals that AGGREGATE INGREDIENTS adds up, for working out what to buy before placing the real order
+// Every accumulator is a plain array indexed by enumerator (or dense topping number), so adding a pizza never looks anything up
+
+struct IngredientTotals
+{
+	std::int64_t pizzas = 0; // How many pizzas these are for (or votes, when weighted by them)
+	std::array<std::int64_t, static_cast<int>(Crust::GLUTENFREE) + 1> crusts{}; // (the UNSPECIFIED entries stay zero)
+	std::array<std::int64_t, static_cast<int>(Sauce::BBQ) + 1> sauces{};
+	std::array<std::int64_t, static_cast<int>(Cheese::DAIRYFREE) + 1> cheeses{};
+	std::array<std::int64_t, toppingCount> topping_halves{}; // Counted in halves of a pizza, since LEFT and RIGHT toppings are
+
+	void add(const Pizza& p, std::int64_t weight); // Counts weight more of p
+};
@@ -22,7 +22,11 @@ enum ErrorID // An enumeration of what particular errors can occur
 	DUPLICATE_TOPPING,
 	AMBIGUOUS_NONE,
 	MISSING_DELIMITER,
-	EXPECTED_DIFFERENT_TOKEN
+	EXPECTED_DIFFERENT_TOKEN,
+	UNCLOSED_BLOCK,
+	INVALID_COMPARATOR,
+	MALFORMED_FILTER,
+	MALFORMED_LIST
 };
 
 class BadInterp: public std::exception // constify all the token ptrs innit
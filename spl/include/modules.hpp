@@ -0,0 +1,25 @@
+#pragma once
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include "statement.hpp"
+
+// Defines the cache of parsed scripts that IMPORT statements pull their statements from
+// A script is lexed and parsed the first time it is imported, and again only if its file has been modified since
+
+namespace modules {
+
+	struct Module
+	{
+		std::filesystem::file_time_type mtime; // When the file was last modified as of parsing it
+		std::shared_ptr<Program> program; // Shared, so that a module stays alive while it runs even if it is reloaded meanwhile
+	};
+
+	inline std::map<std::string, Module> cache; // Keyed by canonical path, and kept for the life of the process
+
+	std::string canonicalPath(const std::string& path); // Returns the empty string if there is no such file
+	std::shared_ptr<Program> load(const std::string& path); // Returns the cached program for path, parsing it if needed
+	// (path must be canonical; a BadInterp is thrown if the file does not parse)
+
+}
@@ -1,17 +1,30 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <cstdint>
 #include "pizza.hpp"
+#include "symbols.hpp"
 
 // Describes the structure of a pizza order
 
+struct ReplicaCount // One replica's share of an order's votes, as a PN-counter: both halves only ever grow,
+{                   // so two copies of it are merged by taking the larger of each half
+	Symbol replica;
+	std::int64_t up = 0;
+	std::int64_t down = 0;
+};
+
+using VoteCounts = std::vector<ReplicaCount>; // An order's votes from every replica that has cast any (one entry each)
+
 struct PizzaOrder
 {
 	Pizza pizza;
 	int votes;
-	std::string name;
+	Symbol name;
+	ToppingOrder written; // The pizza's toppings in the order they were written (or in menu order, if this is left empty)
 
 	PizzaOrder(Pizza p) : pizza{p}, votes{0} {}
-	PizzaOrder(Pizza p, const std::string& n) : pizza{p}, votes{0}, name{n} {}
+	PizzaOrder(Pizza p, Symbol n) : pizza{p}, votes{0}, name{n} {}
 };
 
 inline bool operator<(const PizzaOrder& po1, const PizzaOrder& po2) {
@@ -68,6 +68,14 @@ namespace parser {
 
 	std::unique_ptr<Statement> parseStatement(TokenList& toks); // Forms a sub-list of tokens into a statement
 	Program parse(TokenList& toklst); // Forms an entire program's list of tokens into a list of statements
+	Program parseBlock(TokenList::iterator& tok, TokenList::iterator end, const Token* opener); 
+	// Forms tokens into statements up to the end of the block begun by opener (or up to EOF, if opener is null)
+	Filter parseFilter(TokenList::iterator& tok, TokenList::iterator end, const Token& where);
+	// Compiles the conditions after a WHERE into a filter, leaving tok at the first token that isn't part of them
+	SpecifierList parseSpecifiers(TokenList::iterator& tok, TokenList::iterator end, const Token& before);
+	// Reads a comma-separated list of pizza specifiers, leaving tok at the first token that isn't part of it
+	VoteList parseVotes(TokenList::iterator& tok, TokenList::iterator end, const Token& before);
+	// Likewise, but each specifier may be followed by the number of votes for it (one, if it isn't)
 
 	Program interpret(RawText raw); // Does all of the above steps, converting raw text into an executable program
 	// (It takes its input by value, leaving the original unmodified)
@@ -77,8 +85,10 @@ namespace parser {
 	PizzaElementList parseElements(PizzaElementTextList& pzetl);
 	Pizza parsePizza(PizzaElementList& elements); // Combines a list of pizza elements into an actual pizza
 	Pizza interpretPizza(RawText raw); // Does all of the above steps (also passes by value)
+	ToppingOrder writtenToppings(RawText raw); // The toppings in a pizza's text, in the order they're written there
+	// (a Pizza keeps them in menu order, so this is what a session records to print them in their original order)
 
-	inline Grammar grammar = grammars::SPL_1(); // The grammar which is currently being used
+	inline Grammar grammar = grammars::SPL_1_1(); // The grammar which is currently being used
 
 	inline CharPredicate isSpace = [](char ch) // (the C versions are scuffed)
 	{
@@ -95,6 +105,11 @@ namespace parser {
         return static_cast<unsigned char>(ch) <= 127; 
     };
 
+    inline CharPredicate isComparison = [](char ch)
+    {
+    	return ch == '<' || ch == '=' || ch == '>';
+    };
+
     inline CharPredicate isPizzaPunct = [](char ch)
     {
     	return ch == '{' || ch == '}' || ch == ',';
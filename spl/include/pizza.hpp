@@ -1,12 +1,17 @@
 #pragma once
 #include <vector>
+#include <array>
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <initializer_list>
 
 // Defines the structure of a Pizza
 // (It would be kind of nifty to add customization for different pizza purveyors, but
 // by default this is based on Pizza Nova's menu)
 
-enum class Crust
+enum class Crust : std::uint8_t
 {
 	UNSPECIFIED = 0,
 
@@ -16,7 +21,7 @@ enum class Crust
 	GLUTENFREE
 };
 
-enum class Sauce
+enum class Sauce : std::uint8_t
 {
 	UNSPECIFIED = 0,
 
@@ -27,7 +32,7 @@ enum class Sauce
 	BBQ
 };
 
-enum class Cheese
+enum class Cheese : std::uint8_t
 {
 	UNSPECIFIED = 0,
 
@@ -38,7 +43,7 @@ enum class Cheese
 	DAIRYFREE
 };
 
-enum class Topping
+enum class Topping : std::uint8_t
 {
 	UNSPECIFIED = 0,
 
@@ -79,7 +84,7 @@ enum class Topping
 	PARMESAN
 };
 
-enum class ToppingPosition
+enum class ToppingPosition : std::uint8_t
 {
 	UNSPECIFIED = 0,
 	
@@ -94,19 +99,166 @@ struct ToppingArrangement
 	Topping topping;
 };
 
+// Toppings are numbered densely (meats, then veggies, then cheeses) so each (topping, position) pair gets one bit
+
+inline constexpr int meatCount = static_cast<int>(Topping::CHORIZO);
+inline constexpr int veggieCount = static_cast<int>(Topping::ZUCCHINI) - static_cast<int>(Topping::ARTICHOKE) + 1;
+inline constexpr int cheeseToppingCount = static_cast<int>(Topping::PARMESAN) - static_cast<int>(Topping::ASIAGO) + 1;
+inline constexpr int toppingCount = meatCount + veggieCount + cheeseToppingCount;
+inline constexpr int positionCount = static_cast<int>(ToppingPosition::ALL);
+
+constexpr int denseTopping(Topping t) // Maps a topping to 0 .. toppingCount - 1
+{
+	int n = static_cast<int>(t);
+	if (n < static_cast<int>(Topping::ARTICHOKE)) return n - 1;
+	if (n < static_cast<int>(Topping::ASIAGO)) return meatCount + n - static_cast<int>(Topping::ARTICHOKE);
+	return meatCount + veggieCount + n - static_cast<int>(Topping::ASIAGO);
+}
+
+constexpr Topping sparseTopping(int d) // The inverse of denseTopping
+{
+	if (d < meatCount) return static_cast<Topping>(d + 1);
+	if (d < meatCount + veggieCount) return static_cast<Topping>(d - meatCount + static_cast<int>(Topping::ARTICHOKE));
+	return static_cast<Topping>(d - meatCount - veggieCount + static_cast<int>(Topping::ASIAGO));
+}
+
+using ToppingMask = std::array<std::uint64_t, 2>;
+
+constexpr int runLength(std::uint64_t run) // One less than the length of a nonempty run of set bits starting from bit 0
+{
+	constexpr std::uint64_t debruijn = 0x03F79D71B4CB0A89ULL; // (each 6-bit window of it is different, so a run times it is
+	constexpr std::uint8_t index[64] = {                    // identified by its top six bits)
+		0, 47, 1, 56, 48, 27, 2, 60, 57, 49, 41, 37, 28, 16, 3, 61,
+		54, 58, 35, 52, 50, 42, 21, 44, 38, 32, 29, 23, 17, 11, 4, 62,
+		46, 55, 26, 59, 40, 36, 15, 53, 34, 51, 20, 43, 31, 22, 10, 45,
+		25, 39, 14, 33, 19, 30, 9, 24, 13, 18, 8, 12, 7, 6, 5, 63
+	};
+	return index[(run * debruijn) >> 58];
+}
+
+constexpr int lowestBit(std::uint64_t word) // The index of the lowest set bit of a nonzero word
+{
+	return runLength(word ^ (word - 1)); // (which sets every bit below it, too)
+}
+
+constexpr int highestBit(std::uint64_t word) // The index of the highest set bit of a nonzero word
+{
+	for (int shift = 1; shift < 64; shift *= 2) word |= word >> shift; // (which sets every bit below it)
+	return runLength(word);
+}
+
+constexpr int bitCount(std::uint64_t word)
+{
+	word -= (word >> 1) & 0x5555555555555555ULL;
+	word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+	word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+}
+
+class ToppingSet // The toppings on a pizza, as a bitset (they come out in menu order, whatever order they were added in;
+{                // a session keeps the order each order's toppings were written in beside it, for printing)
+public:
+	static constexpr std::size_t capacity = toppingCount * positionCount;
+	static_assert(capacity <= 128, "ToppingMask has room for 128 arrangements");
+
+	static constexpr std::size_t bitOf(ToppingArrangement ta)
+	{
+		return denseTopping(ta.topping) * positionCount + static_cast<int>(ta.position) - 1;
+	}
+
+	static constexpr ToppingArrangement arrangementOf(std::size_t bit)
+	{
+		return ToppingArrangement{static_cast<ToppingPosition>(bit % positionCount + 1), sparseTopping(static_cast<int>(bit / positionCount))};
+	}
+
+	class const_iterator // Yields the arrangements in menu order (meats, veggies, then cheeses; left, right, then all of each)
+	{
+	private:
+		ToppingMask left; // The bits not yet visited
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = ToppingArrangement;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const ToppingArrangement*;
+		using reference = ToppingArrangement; // (arrangements are made on the fly, so they are returned by value)
+
+		constexpr const_iterator(const ToppingMask& m) : left{m} {}
+		constexpr ToppingArrangement operator*() const
+		{
+			return arrangementOf(left[0] ? lowestBit(left[0]) : 64 + lowestBit(left[1]));
+		}
+		constexpr const_iterator& operator++()
+		{
+			if (left[0]) left[0] &= left[0] - 1;
+			else left[1] &= left[1] - 1;
+			return *this;
+		}
+		constexpr const_iterator operator++(int) { const_iterator old = *this; ++*this; return old; }
+		constexpr bool operator==(const const_iterator& other) const { return left[0] == other.left[0] && left[1] == other.left[1]; }
+		constexpr bool operator!=(const const_iterator& other) const { return !(*this == other); }
+	};
+
+	constexpr ToppingSet() : bits{0, 0} {}
+	constexpr ToppingSet(std::initializer_list<ToppingArrangement> tas) : ToppingSet()
+	{
+		for (ToppingArrangement ta : tas) insert(ta);
+	}
+
+	constexpr bool contains(ToppingArrangement ta) const
+	{
+		std::size_t b = bitOf(ta);
+		return (bits[b / 64] >> (b % 64)) & 1;
+	}
+
+	constexpr bool insert(ToppingArrangement ta) // Returns false, changing nothing, if ta is already there
+	{
+		if (contains(ta)) return false;
+		std::size_t b = bitOf(ta);
+		bits[b / 64] |= std::uint64_t{1} << (b % 64);
+		return true;
+	}
+
+	constexpr bool erase(ToppingArrangement ta) // Returns false, changing nothing, if ta isn't there
+	{
+		if (!contains(ta)) return false;
+		std::size_t b = bitOf(ta);
+		bits[b / 64] &= ~(std::uint64_t{1} << (b % 64));
+		return true;
+	}
+
+	constexpr const ToppingMask& mask() const { return bits; }
+	constexpr std::size_t size() const { return bitCount(bits[0]) + bitCount(bits[1]); }
+	constexpr bool empty() const { return (bits[0] | bits[1]) == 0; }
+	constexpr const_iterator begin() const { return const_iterator(bits); }
+	constexpr const_iterator end() const { return const_iterator(ToppingMask{0, 0}); }
+
+	friend constexpr bool operator==(const ToppingSet& ts1, const ToppingSet& ts2)
+	{
+		return ts1.bits[0] == ts2.bits[0] && ts1.bits[1] == ts2.bits[1];
+	}
+
+private:
+	ToppingMask bits;
+};
+
+using ToppingOrder = std::vector<ToppingArrangement>; // A pizza's toppings in the order they were written (and are printed in)
+
+inline constexpr std::uint64_t meatMask = (std::uint64_t{1} << meatCount * positionCount) - 1; // Meats take up the low bits of the first word
+static_assert(meatCount * positionCount < 64, "meatMask only covers the first word");
+
 struct Pizza
 {
 	Crust crust;
 	Sauce sauce;
 	Cheese cheese;
-	std::vector<ToppingArrangement> toppings;
+	ToppingSet toppings;
 };
 
 inline Crust defaultCrust = Crust::STANDARD;
 inline Sauce defaultSauce = Sauce::TOMATO;
 inline Cheese defaultCheese = Cheese::MOZZARELLA;
-inline Pizza defaultPizza = {defaultCrust, defaultSauce, defaultCheese, std::vector<ToppingArrangement>{}};
-inline Pizza nullPizza = {Crust::UNSPECIFIED, Sauce::UNSPECIFIED, Cheese::UNSPECIFIED, std::vector<ToppingArrangement>{}};
+inline Pizza defaultPizza = {defaultCrust, defaultSauce, defaultCheese, ToppingSet{}};
+inline Pizza nullPizza = {Crust::UNSPECIFIED, Sauce::UNSPECIFIED, Cheese::UNSPECIFIED, ToppingSet{}};
 
 template<typename T>
 inline bool containsItem(const std::vector<T>& v, T item)
@@ -124,17 +276,35 @@ inline bool sameContents(const std::vector<T>& v1, const std::vector<T>& v2)
 		v2.end());
 }
 
-inline bool operator==(const ToppingArrangement& ta1, const ToppingArrangement& ta2)
+constexpr bool operator==(const ToppingArrangement& ta1, const ToppingArrangement& ta2)
 {
 	return (ta1.topping == ta2.topping) && (ta1.position == ta2.position);
 }
 
-inline bool operator==(const Pizza& p1, const Pizza& p2)
+constexpr bool operator==(const Pizza& p1, const Pizza& p2)
 {
 	return (p1.crust == p2.crust) 
 		&& (p1.sauce == p2.sauce)
 		&& (p1.cheese == p2.cheese) 
-		&& sameContents(p1.toppings, p2.toppings);
+		&& (p1.toppings == p2.toppings);
+}
+
+inline std::uint64_t mixBits(std::uint64_t x)
+{ // The finalizer from splitmix64, which spreads every bit of x over the whole result
+	x ^= x >> 30;
+	x *= 0xBF58476D1CE4E5B9ULL;
+	x ^= x >> 27;
+	x *= 0x94D049BB133111EBULL;
+	x ^= x >> 31;
+	return x;
+}
+
+inline std::uint64_t fingerprint(const Pizza& p)
+{ // Equal pizzas have equal fingerprints, since the topping bitset doesn't record the order toppings were added in
+	std::uint64_t base = static_cast<std::uint64_t>(p.crust) 
+		| static_cast<std::uint64_t>(p.sauce) << 8 
+		| static_cast<std::uint64_t>(p.cheese) << 16;
+	return mixBits(mixBits(base ^ p.toppings.mask()[0]) ^ p.toppings.mask()[1]);
 }
 
 inline bool glutenFreeHuh(const Pizza& p) 
@@ -149,10 +319,7 @@ inline bool dairyFreeHuh(const Pizza& p)
 
 inline bool vegetarianHuh(const Pizza& p) 
 {
-	return std::all_of(
-		p.toppings.begin(), 
-		p.toppings.end(), 
-		[](const ToppingArrangement& t) { return static_cast<int>(t.topping) >= 100; }); 
+	return (p.toppings.mask()[0] & meatMask) == 0; 
 }
 
 inline bool veganHuh(const Pizza& p) 
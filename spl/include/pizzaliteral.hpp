@@ -0,0 +1,165 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <string_view>
+#include "pizza.hpp"
+#include "syntax.hpp"
+
+// Defines the _pizza literal, which turns a pizza specifier like "[{Pesto}, {Left: Ham}]"_pizza into a Pizza
+// It follows the same rules as parser::interpretPizza, using the names in syntax.hpp; when it initializes a constexpr variable
+// it's parsed at compile time, and a malformed literal is a compile error rather than an exception
+
+namespace pizzaliteral {
+
+	inline void malformed(const char* why) // Deliberately not constexpr: reaching it while evaluating a literal is a compile error
+	{                                      // whose diagnostic quotes the call, and with it the reason
+		throw std::invalid_argument(why);
+	}
+
+	constexpr bool isSpace(char ch)
+	{
+		return ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r' || ch == '\v';
+	}
+
+	constexpr char toUpper(char ch)
+	{
+		return ('a' <= ch && ch <= 'z') ? static_cast<char>(ch - 'a' + 'A') : ch;
+	}
+
+	constexpr std::string_view stripWhitespace(std::string_view s)
+	{
+		while (!s.empty() && isSpace(s.front())) s.remove_prefix(1);
+		while (!s.empty() && isSpace(s.back())) s.remove_suffix(1);
+		return s;
+	}
+
+	constexpr bool sameName(std::string_view s, std::string_view name) // Names are not case-sensitive
+	{
+		if (s.size() != name.size()) return false;
+		for (std::size_t i = 0; i < s.size(); ++i) {
+			if (toUpper(s[i]) != name[i]) return false;
+		}
+		return true;
+	}
+
+	template<typename T, std::size_t N>
+	constexpr T lookup(std::string_view s, const Name<T> (&names)[N]) // Returns UNSPECIFIED if s is not one of the names
+	{
+		for (const Name<T>& n : names) {
+			if (sameName(s, n.text)) return n.value;
+		}
+		return static_cast<T>(0);
+	}
+
+	constexpr void addTopping(Pizza& lit, ToppingArrangement ta)
+	{
+		if (!lit.toppings.insert(ta)) malformed("Duplicate topping");
+	}
+
+	constexpr void addElement(Pizza& lit, std::string_view elem) // elem is the text between a pair of braces
+	{
+		elem = stripWhitespace(elem);
+		if (elem.empty()) malformed("Empty element");
+
+		std::size_t colon = elem.find(':');
+
+		if (colon == std::string_view::npos) { // perform type inference, in the same order as the parser
+
+			if (sameName(elem, "NONE")) {
+				malformed("Ambiguous \"NONE\" (Did you mean no sauce or no cheese?)");
+			} else if (Crust c = lookup(elem, crustNames); c != Crust::UNSPECIFIED) {
+				if (lit.crust != Crust::UNSPECIFIED) malformed("Redefinition of crust is not allowed");
+				lit.crust = c;
+			} else if (Sauce s = lookup(elem, sauceNames); s != Sauce::UNSPECIFIED) {
+				if (lit.sauce != Sauce::UNSPECIFIED) malformed("Redefinition of sauce is not allowed");
+				lit.sauce = s;
+			} else if (Cheese ch = lookup(elem, cheeseNames); ch != Cheese::UNSPECIFIED) {
+				if (lit.cheese != Cheese::UNSPECIFIED) malformed("Redefinition of cheese is not allowed");
+				lit.cheese = ch;
+			} else if (Topping t = lookup(elem, topNames); t != Topping::UNSPECIFIED) {
+				addTopping(lit, ToppingArrangement{ToppingPosition::ALL, t});
+			} else {
+				malformed("Unrecognized topping or element");
+			}
+
+		} else if (elem.find(':', colon + 1) == std::string_view::npos) { // explicit element type is on the left
+
+			std::string_view part = stripWhitespace(elem.substr(0, colon));
+			std::string_view which = stripWhitespace(elem.substr(colon + 1));
+
+			if (sameName(part, "CRUST")) {
+				Crust c = lookup(which, crustNames);
+				if (c == Crust::UNSPECIFIED) malformed("Unrecognized crust");
+				if (lit.crust != Crust::UNSPECIFIED) malformed("Redefinition of crust is not allowed");
+				lit.crust = c;
+			} else if (sameName(part, "SAUCE")) {
+				Sauce s = lookup(which, sauceNames);
+				if (s == Sauce::UNSPECIFIED) malformed("Unrecognized sauce");
+				if (lit.sauce != Sauce::UNSPECIFIED) malformed("Redefinition of sauce is not allowed");
+				lit.sauce = s;
+			} else if (sameName(part, "CHEESE")) {
+				Cheese ch = lookup(which, cheeseNames);
+				if (ch == Cheese::UNSPECIFIED) malformed("Unrecognized cheese");
+				if (lit.cheese != Cheese::UNSPECIFIED) malformed("Redefinition of cheese is not allowed");
+				lit.cheese = ch;
+			} else if (ToppingPosition p = lookup(part, posNames); p != ToppingPosition::UNSPECIFIED) {
+				Topping t = lookup(which, topNames);
+				if (t == Topping::UNSPECIFIED) malformed("Unrecognized topping");
+				addTopping(lit, ToppingArrangement{p, t});
+			} else {
+				malformed("Not a pizza component");
+			}
+
+		} else {
+			malformed("Too many colons in pizza element specifier");
+		}
+	}
+
+	constexpr Pizza parse(std::string_view text) // Does what parser::interpretPizza does
+	{
+		Pizza lit{Crust::UNSPECIFIED, Sauce::UNSPECIFIED, Cheese::UNSPECIFIED, ToppingSet{}};
+		text = stripWhitespace(text);
+		if (text.size() < 2 || text.front() != '[' || text.back() != ']') malformed("A pizza literal must be enclosed in [ ]");
+		text = stripWhitespace(text.substr(1, text.size() - 2)); // (an empty literal is just the default pizza)
+
+		char expects = text.empty() ? ',' : '{';
+		std::size_t elem_begin = 0;
+
+		for (std::size_t i = 0; i < text.size(); ++i) {
+			char ch = text[i];
+			if (ch == expects) {
+				switch (expects) {
+					case '{':
+						elem_begin = i + 1;
+						expects = '}';
+						break;
+					case '}':
+						addElement(lit, text.substr(elem_begin, i - elem_begin));
+						expects = ',';
+						break;
+					case ',':
+						expects = '{';
+						break;
+				}
+			} else if (ch == '{' || ch == '}' || ch == ',') {
+				malformed("Misplaced '{', '}', or ','");
+			} else if (expects != '}' && !isSpace(ch)) {
+				malformed("Unexpected character");
+			}
+		}
+
+		if (expects == '{') malformed("Expected a '{' before the end of the pizza specifier");
+		if (expects == '}') malformed("Expected a '}' before the end of the pizza specifier");
+
+		if (lit.cheese == Cheese::UNSPECIFIED) lit.cheese = Cheese::MOZZARELLA;
+		if (lit.sauce == Sauce::UNSPECIFIED) lit.sauce = Sauce::TOMATO;
+		if (lit.crust == Crust::UNSPECIFIED) lit.crust = Crust::STANDARD;
+
+		return lit;
+	}
+}
+
+constexpr Pizza operator""_pizza(const char* text, std::size_t length) // e.g. constexpr Pizza p = "[{Pesto}, {Left: Ham}]"_pizza;
+{
+	return pizzaliteral::parse(std::string_view(text, length));
+}
\ No newline at end of file
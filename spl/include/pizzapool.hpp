@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "pizza.hpp"
+
+// Defines the pool that a session's orders keep their pizzas in
+// Each distinct pizza is stored once and shared by every order of it, so orders hold a small reference instead of
+// a whole Pizza, and two orders are for the same pizza exactly when their references are equal
+// Pooled pizzas are never modified; altering an order's pizza interns the altered copy and releases the original
+
+using PizzaRef = std::uint32_t;
+
+class PizzaPool
+{
+public:
+	static constexpr PizzaRef none = static_cast<PizzaRef>(-1);
+
+	PizzaRef intern(const Pizza& p); // Returns the reference for p, pooling it if it's new, and counts one more use of it
+	void retain(PizzaRef ref); // Counts one more use of ref
+	void release(PizzaRef ref); // Counts one less use of ref, freeing its entry once nothing uses it
+	PizzaRef find(const Pizza& p) const; // Returns none if p isn't in the pool
+
+	const Pizza& operator[](PizzaRef ref) const;
+	std::size_t size() const; // The number of distinct pizzas in the pool
+	PizzaRef capacity() const; // One past the largest reference handed out so far
+	bool occupied(PizzaRef ref) const; // Whether ref is in use (rather than a vacant entry)
+
+private:
+	std::vector<Pizza> entries;
+	std::vector<std::uint32_t> uses; // Zero for a vacant entry
+	std::vector<PizzaRef> vacant; // Entries to reuse before growing
+	std::unordered_multimap<std::uint64_t, PizzaRef> by_fingerprint;
+};
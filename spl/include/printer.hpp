@@ -14,6 +14,7 @@ namespace printer {
 
 	void showPizza(Pizza p); // Prints a human-readable description of a pizza
 	// e.g. "Ham, Pepperoni, Pineapple, Pesto Base, Thin Crust."
+	void showPizza(const Pizza& p, const ToppingOrder& written); // Likewise, listing its toppings in written's order
 
 	void showPizzaWithInfo(Pizza p); // Prints a human-readable description of a pizza with added detail
 	// e.g. "Spinach, Onion, Asiago Cheese, No Mozzarella Cheese, Olive Oil Base, Standard Crust" 
@@ -33,10 +34,41 @@ namespace printer {
 	// e.g. "MathNews Prod Night 04/03/2024: 23 pizzas ordered."
 	// *list all of the pizzas*
 
+	void showMatchingOrders(const OrderSession& os, const SlotSet& slots, bool pizza_deets); // Prints the orders in slots, in order
+	// e.g. "3 pizzas match."
+	// *list those pizzas*
+
 	void showTopOrders(const OrderSession& os, int n); // Prints the top n pizza orders, or all of them if os has fewer than n orders
+	void showTopOrders(const OrderSession& os, int n, const SlotSet& among); // Likewise, but only out of the orders in among
+	void showApproximateTop(const OrderSession& os, int n); // Prints the top n pizzas in an approximate session's sketch,
+	// along with the range each one's votes are in
+	// e.g. "Top 2 orders, approximately (1200 votes from about 800 voters for about 340 distinct pizzas):"
+	// ""Meat Lovers": Pepperoni, Bacon, Tomato Sauce, Standard Crust. [310 votes]"
+	// "Pineapple, Ham, Tomato Sauce, Standard Crust. [95 to 104 votes]"
+	// "(Any other pizza has at most 9 votes.)"
+
+	void showStandings(const OrderSession& os, int n, Tally how); // Prints the top n orders when the ballots are tallied
+	// in the given way, with each one's score (for a runoff, its votes in the last round it was still standing)
+	// e.g. "Top 2 orders by Borda count (from 40 ballots):"
+	// ""Cheeza": Feta Cheese, Triple Mozzarella Cheese. [97 points]"
+	// "Pepperoni. [81 points]"
+
+	void showNearestOrders(const OrderSession& os, const Pizza& p, int n, bool pizza_deets); // Prints the n orders most like p,
+	// along with how alike each one is
+	// e.g. "Nearest 2 orders:"
+	// "(100%) #3: Pepperoni, Tomato Sauce, Standard Crust. [2 votes]"
+	// "(75%) #7 "Half and Half": Pepperoni (Left), Tomato Sauce, Standard Crust. [0 votes]"
+
+	void showIngredients(const IngredientTotals& totals, bool by_votes); // Prints how much of each ingredient is needed
+	// e.g. "Ingredients for 3 pizzas:"
+	// "Standard Crust: 3"
+	// "Tomato Sauce: 3"
+	// "Mozzarella Cheese: 3"
+	// "Pepperoni: 2.5"
 
 	void reportSuccess(); // Reports that no runtime errors have occurred
 	void reportError(); // Reports that a runtime error was encountered (which is recorded in statement.cpp)
+	void reportRollback(); // Reports that an open transaction was rolled back because of a runtime error
 	void reportRuntimeError(const std::string& txt, ProgramState& ps); // Prints txt on its own line
 	void reportRuntimeError(const char* txt, ProgramState& ps);
 	void reportInterpError(BadInterp& error, ProgramState& ps); // Reports an interpret-time error in detail
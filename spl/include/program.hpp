@@ -6,6 +6,8 @@
 #include <sstream>
 #include <optional>
 #include <algorithm>
+#include <functional>
+#include <random>
 #include "session.hpp"
 #include "statement.hpp"
 #include "parsetypes.hpp"
@@ -14,6 +16,11 @@
 
 enum class State { READ, INTERPRET, EXECUTE };
 
+struct ProgramState;
+
+using UndoAction = std::function<void(ProgramState&)>; // Reverts the effect of a single statement
+using UndoLog = std::vector<UndoAction>;
+
 struct ProgramState
 {
 	State state;
@@ -25,12 +32,46 @@ struct ProgramState
 	int programcounter;
 	bool running;
 
+	std::optional<UndoLog> undolog; // Present if and only if a transaction is open
+	bool sketch_kept = false; // Whether the open transaction already has a copy of the session's sketch to go back to
+	std::vector<std::string> imports; // The scripts being imported right now, innermost last
+
 	std::string PROMPT = "> ";
 	bool norepl = false;
+	bool atomic = false; // Run each script (or REPL input) as a single transaction
+	bool emitcpp = false; // Transpile each script to C++ instead of running it
+	Symbol replica = randomReplica(); // Who this instance's votes are counted for when sessions are merged (see -replica)
 
-	ProgramState() : state{State::READ}, programcounter{0}, running{true} 
+	ProgramState() : state{State::READ}, programcounter{0}, running{true}
 	{ ; }
 
+	static Symbol randomReplica() // Instances that weren't given a name with -replica get a random one, so no two share it
+	{
+		std::random_device rd;
+		std::ostringstream name;
+		name << std::hex << rd() << rd();
+		return Symbol::of(name.str());
+	}
+
+	void logUndo(UndoAction ua) // Records how to revert a statement, if there is a transaction to revert it in
+	{
+		if (undolog) undolog->push_back(std::move(ua));
+	}
+
+	void beginTransaction() { undolog.emplace(); sketch_kept = false; }
+	void commitTransaction() { undolog.reset(); sketch_kept = false; } // The log is simply discarded
+
+	void rollbackTransaction() // Applies the undo log from newest to oldest, so each action sees the state it was recorded in
+	{
+		if (!undolog) return;
+		UndoLog log = std::move(*undolog);
+		undolog.reset();
+		sketch_kept = false;
+		for (auto it = log.rbegin(); it != log.rend(); ++it) {
+			(*it)(*this);
+		}
+	}
+
 	void readSource(std::istream& source)
 	{
 		std::ostringstream source_buffer; // set up an ostringstream
@@ -0,0 +1,96 @@
+#pragma once
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// Defines a column of variable-length runs, one per slot, for the parts of an order that are lists
+// Like a ballot box, it keeps every run end to end in one array, with a start and a length for each slot, so a slot
+// costs eight bytes plus its run instead of a vector of its own
+// A run that's replaced by a longer one moves to the end of the array, leaving the old one behind as garbage, which is
+// squeezed out once there's more of it than there is of the runs themselves
+
+template<typename T>
+class RunColumn
+{
+public:
+	std::size_t size() const { return starts.size(); } // The number of slots
+	std::size_t length(std::size_t slot) const { return lengths[slot]; }
+	T* begin(std::size_t slot) { return items.data() + starts[slot]; } // Slot's run goes from begin(slot) up to end(slot)
+	T* end(std::size_t slot) { return begin(slot) + lengths[slot]; }
+	const T* begin(std::size_t slot) const { return items.data() + starts[slot]; }
+	const T* end(std::size_t slot) const { return begin(slot) + lengths[slot]; }
+
+	void reserve(std::size_t slots) // (only the starts and lengths, since how long the runs will be isn't known)
+	{
+		starts.reserve(slots);
+		lengths.reserve(slots);
+	}
+
+	template<typename It> void push_back(It first, It last) // Adds a slot at the end, with the run from first up to last
+	{
+		insert(size(), first, last);
+	}
+
+	template<typename It> void insert(std::size_t slot, It first, It last) // Likewise, but before slot (which moves up one)
+	{
+		starts.insert(starts.begin() + slot, static_cast<std::uint32_t>(items.size()));
+		lengths.insert(lengths.begin() + slot, static_cast<std::uint32_t>(std::distance(first, last)));
+		items.insert(items.end(), first, last);
+		used += lengths[slot];
+	}
+
+	template<typename It> void assign(std::size_t slot, It first, It last) // Replaces slot's run with the one from first up to last
+	{ // (which mustn't be in this column)
+		std::uint32_t n = static_cast<std::uint32_t>(std::distance(first, last));
+		if (n > lengths[slot]) { // (one that's no longer fits where the old one was)
+			starts[slot] = static_cast<std::uint32_t>(items.size());
+			items.insert(items.end(), first, last);
+		} else {
+			std::copy(first, last, begin(slot));
+		}
+		used = used - lengths[slot] + n;
+		lengths[slot] = n;
+
+		std::size_t garbage = items.size() - used;
+		if (garbage > used && garbage >= 32) pack();
+	}
+
+	void pop_back()
+	{
+		used -= lengths.back();
+		if (starts.back() + lengths.back() == items.size()) items.resize(starts.back());
+		starts.pop_back();
+		lengths.pop_back();
+	}
+
+	void keep(const std::vector<bool>& live) // Drops the slots that aren't live, renumbering the rest (and squeezes out the garbage)
+	{
+		RunColumn kept;
+		kept.items.reserve(used);
+		for (std::size_t slot = 0; slot < size(); ++slot) {
+			if (live[slot]) kept.push_back(begin(slot), end(slot));
+		}
+		*this = std::move(kept);
+	}
+
+	void clear()
+	{
+		items.clear();
+		starts.clear();
+		lengths.clear();
+		used = 0;
+	}
+
+private:
+	void pack() // Squeezes out the garbage, laying the runs out in slot order
+	{
+		keep(std::vector<bool>(size(), true));
+	}
+
+	std::vector<T> items;
+	std::vector<std::uint32_t> starts;
+	std::vector<std::uint32_t> lengths;
+	std::size_t used = 0; // How much of items belongs to some slot's run (the rest is garbage)
+};
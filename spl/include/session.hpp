@@ -1,46 +1,167 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <set>
+#include <utility>
+#include <tuple>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <optional>
 #include "order.hpp"
+#include "runcolumn.hpp"
+#include "pizzapool.hpp"
+#include "slotset.hpp"
+#include "suffixindex.hpp"
+#include "similarity.hpp"
+#include "ingredients.hpp"
+#include "sketch.hpp"
+#include "ballots.hpp"
+#include "voters.hpp"
 
 // Defines the logic and operations for a pizza ordering session
+// The orders are stored as parallel columns, so that voting and tallying only touch the (contiguous) votes,
+// and everything else about an order is only read when it is looked up or printed
+// Each order has a stable ID, which is what (n) refers to; removing an order only leaves a tombstone in its slot,
+// and the tombstones are compacted away once they outnumber the live orders
+// Each vote count is tagged with the epoch it was cast in, so resetting the votes only has to start a new epoch
+// Behind each count is a PN-counter per replica (i.e. per plang instance voting on its own copy of the session), so that
+// copies saved at different sites can be merged without losing or double-counting anyone's votes
+// The counters are only brought up to date with the tallies (settled) when they're read, so voting never touches them
+// An approximate session counts its votes in a fixed-size sketch instead, and only knows roughly what the top pizzas are
 
 class OrderSession
 {
 public: // This makes the implementation less of a headache
-	std::vector<PizzaOrder> orders;
-	std::string session_name;
+	std::vector<int> votes; // Hot columns: slot i of each column belongs to the same order
+	std::vector<std::uint32_t> vote_epochs; // (a count from before the current epoch reads as zero; see tally)
+	std::vector<PizzaRef> pizza_refs; // (each order's pizza, in the pool)
+	std::vector<int> ids; // Ascending, since orders are only ever appended and compaction keeps them in order
+	std::vector<bool> live; // False for a tombstone
+	std::vector<Symbol> names; // Cold columns
+	RunColumn<ReplicaCount> vote_counts; // (as they were last settled; this replica's votes since make up the rest of the tally)
+	RunColumn<std::uint8_t> arrangements; // (each pizza's toppings by their bits, in the order they were written; see written)
+	// Read the columns freely, but only modify them through the member functions so they and the indices stay in sync
+
+	Symbol session_name;
+	Symbol replica; // Who the votes cast here are counted for
+	PizzaPool pool;
+	std::optional<VoteSketch> sketch; // Present if and only if the session is approximate, in which case every tally stays zero
+	BallotBox ranked_ballots; // The ballots cast with BALLOT RANKED, and with BALLOT APPROVAL
+	BallotBox approval_ballots; // (these are kept apart from the tallies, and don't affect them)
+	VoterTable voters; // What each voter who has voted BY name has voted for (their votes are in the tallies, too)
+
+	static constexpr std::size_t npos = static_cast<std::size_t>(-1); // The slot of an order that doesn't exist
+
+	int next_id = 1; // IDs are never reused, so a stale ID finds nothing rather than the wrong order
+	int first_id = 1; // The lowest ID in slot_of (a fresh session doesn't map the IDs from before, since none of them can be found)
+	std::uint32_t epoch = 0; // Bumped every time the votes are reset
+	std::size_t live_count = 0;
+	std::vector<std::size_t> slot_of; // Maps each ID from first_id on to its slot, or to npos once it is removed
+
+	std::unordered_multimap<Symbol, std::size_t> name_index; // Maps each name to every live slot with it
+	// (unnamed orders are left out, since they would all share one bucket that every change to one of them had to search)
+	SuffixIndex name_suffixes; // Holds every name in name_index, for LIKE
+	std::vector<SlotSet> pizza_index; // Maps each pooled pizza (by its reference) to every live slot with it
+	std::vector<std::size_t> first_with; // And to the lowest of them, or npos if there are none (which is what locate finds)
+	std::array<SlotSet, ToppingSet::capacity> topping_index; // Maps each topping arrangement (by its bit) to every live slot with it
+
+	using Ranking = std::tuple<std::uint32_t, int, std::size_t>; // (epoch, votes, slot)
+
+	struct MoreVotes // Ranks the current epoch first, then from most votes to fewest, with ties going to the earlier order
+	{
+		bool operator()(const Ranking& r1, const Ranking& r2) const
+		{
+			if (std::get<0>(r1) != std::get<0>(r2)) return std::get<0>(r1) > std::get<0>(r2);
+			if (std::get<1>(r1) != std::get<1>(r2)) return std::get<1>(r1) > std::get<1>(r2);
+			return std::get<2>(r1) < std::get<2>(r2);
+		}
+	};
+	std::set<Ranking, MoreVotes> leaderboard; // Every live order with a nonzero tally, kept in rank order as votes come in
+	// (entries from earlier epochs sink to the end, and are swept away a few at a time as votes come in)
 
 public:
 	OrderSession();
 	OrderSession(int n);
-	OrderSession(const std::string& n);
-	OrderSession(const std::string& nm, int nmb);
+	OrderSession(Symbol n);
+	OrderSession(Symbol nm, int nmb);
 
-	void add(const PizzaOrder& p);
-	void rename(const std::string& n);
+	std::size_t size() const; // The number of live orders
+	std::size_t slots() const; // The number of slots, tombstones included
+	PizzaOrder order(std::size_t slot) const; // Gathers the order in slot from every column (for printing and such)
+	const Pizza& pizza(std::size_t slot) const;
+	ToppingOrder written(std::size_t slot) const; // The toppings on the order's pizza, in the order they were written
+	OrderSession fresh() const; // An empty session with the same name, which carries on numbering from this one
 
-	std::vector<PizzaOrder>::iterator locateIt(int pizza_number); 
-	std::vector<PizzaOrder>::iterator locateIt(const std::string& pizza_name);
-	std::vector<PizzaOrder>::iterator locateIt(Pizza pizza_replica);
+	int add(const Pizza& p, Symbol name, const ToppingOrder& written = {}); // Returns the new order's ID
+	// (any toppings that written leaves out are taken to have been written after the rest, in menu order)
+	int add(const Pizza& p, Symbol name, const ToppingOrder& written, const VoteCounts& counts); // Likewise, for an order
+	// that already has votes
+	void remove(std::size_t slot);
+	void remove(const SlotSet& doomed); // Removes every order in doomed in one pass, then rebuilds the indices once
+	void removeLast(); // Only for undoing the latest add, since it gives the order's ID back
+	void reinstate(int id, const PizzaOrder& po, const VoteCounts& counts); // Brings back a removed order under its old ID
+	// (for undoing a removal)
+	void rename(Symbol n);
+	void renameOrder(std::size_t slot, Symbol n);
+	void setPizza(std::size_t slot, const Pizza& p, const ToppingOrder& written); // (its toppings are put in written's order)
+	void setPizza(std::size_t slot, const Pizza& p); // Likewise, keeping the toppings that stay in the order they were in,
+	// with any new ones last
+	void setPizzas(const SlotSet& chosen, const std::function<bool(Pizza&)>& alter); // Likewise, for every order in chosen
+	// (alter is applied once per distinct pizza, and returns false if it left the pizza as it was)
+	void reindex(); // Rebuilds the ID table, the indices, and the leaderboard from scratch
 
-	unsigned int locateIndex(int pizza_number);
-	unsigned int locateIndex(const std::string& pizza_name);
-	unsigned int locateIndex(Pizza pizza_replica);
+	std::size_t locate(int pizza_id) const; // These return the slot of the order, or npos if there is no such order
+	std::size_t locate(Symbol pizza_name) const;
+	std::size_t locate(const Pizza& pizza_replica) const;
+	const SlotSet& withTopping(ToppingArrangement ta) const; // Every live slot whose pizza has exactly ta on it
+	SlotSet like(std::string_view pattern) const; // Every live slot whose name matches pattern (an unnamed order never does)
 
-	bool located(int pizza_number); 
-	bool located(const std::string& pizza_name);
-	bool located(Pizza pizza_replica);
+	int tally(std::size_t slot) const; // The votes for the order in slot this epoch
+	VoteCounts counts(std::size_t slot) const; // The counters behind them, settled (with any reset since they were cast counted
+	// against them)
+	void vote(std::size_t slot, int amount=1);
+	void setVote(std::size_t slot, int t);
+	VoterTable::Entry voteAs(Symbol voter, std::size_t slot, int amount); // Replaces whatever vote voter had with amount votes
+	// for slot, adjusting the tallies by the difference, and returns the voter's entry as it was (for undoing)
+	void setVoter(const VoterTable::Entry& e); // Makes e the voter's entry, likewise taking back the vote they had
+	std::vector<std::size_t> topSlots(int n, const SlotSet* among = nullptr) const; // The slots of the n orders with the most votes,
+	// most first (only counting the slots in among, if it's given)
+	std::vector<std::pair<std::size_t, Similarity>> nearest(const Pizza& p, int n) const; // The slots of the n orders most like p,
+	// most alike first, with ties going to the earlier order
 
-	PizzaOrder& locate(int pizza_number); // handle the try/catch stuff at runtime with located
-	PizzaOrder& locate(const std::string& pizza_name);
-	PizzaOrder& locate(Pizza pizza_replica);
+	std::vector<std::pair<std::size_t, std::int64_t>> standings(Tally how, int n) const; // The slots of the n orders that come
+	// out on top when the ballots are tallied in the given way, best first, with the score each got (this lives in ballots.cpp)
 
-	void vote(int pizza_number, int amount=1);
-	void vote(const std::string& pizza_name, int amount=1);
-	void vote(Pizza pizza_replica, int amount=1);
+	IngredientTotals ingredients(bool by_votes, const std::vector<std::size_t>* among = nullptr) const; // What every order
+	// needs altogether (or just the orders in among), each counted once or, if by_votes, once per vote (none if it has fewer than one)
 
-	//std::vector<PizzaOrder> tally(int winners);
-	void resetVotes();
+	void resetVotes(); // Constant time
 	void reset();
+
+	void merge(const OrderSession& other); // Adds other's orders and votes to this session's, in time proportional to both
+	// (give or take a logarithm for each order that's added or whose tally moves, as it's ranked on the leaderboard)
+	// Orders are the same when they have equal pizzas and names (the nth such order in each session pairs up with the nth
+	// in the other), and their counters are merged; the rest are added, in other's order. Merging the same orders twice
+	// changes nothing the second time. Removals aren't merged, though, so merging brings back any order removed since
+	// Nor are ballots, since two copies of a ballot can't be told from two ballots that happen to be alike,
+	// and this session's record of who voted for what is kept as it is
+
+	void write(std::ostream& out); // Saves the session in plang's session file format (these two live in sessionfile.cpp)
+	// (settling every order's counters first, since the copy saved may be merged back into this one)
+	static OrderSession read(std::istream& in); // Loads a session saved by write, with its order IDs and counters intact
+	// (it throws a std::runtime_error saying what's wrong if in doesn't hold a saved session)
+
+private:
+	void index(std::size_t slot); // Adds a live slot to the indices and the leaderboard
+	void unindex(std::size_t slot); // Takes a slot out of them again, before it changes or goes away
+	void compact(); // Squeezes the tombstones out, renumbering the slots (but not the IDs)
+	void sweep(int n); // Drops up to n leaderboard entries left over from earlier epochs
+	void rearrange(std::size_t slot); // Brings the order's arrangement in line with its pizza, as setPizza describes
+	void rank(std::size_t slot, int t); // Makes t the slot's tally this epoch, moving it on the leaderboard (but not counting it)
+	std::size_t& slotOf(int id) { return slot_of[id - first_id]; }
+	void settle(std::size_t slot); // Stores the order's counters as counts has them
+	void recast(VoterTable::Entry& current, const VoterTable::Entry& e); // Replaces a voter's entry, and the votes it accounts for
 };
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+#include "pizza.hpp"
+
+// Defines how alike two pizzas are, for finding the orders nearest to a pizza that nobody ordered
+// A pizza is treated as a set of features, and two pizzas are as similar as the weighted Jaccard index of their sets:
+// each half of the pizza that a topping covers is a feature of weight one, and the crust, sauce, and cheese are features
+// of weight two, since they cover both halves. So [{Left: Ham}] shares half its ham with [{Ham}], and equal pizzas are 100% alike
+
+struct Similarity
+{
+	int shared = 0; // The weight of the features both pizzas have
+	int total = 1; // The weight of the features either one has
+
+	int percent() const { return shared * 100 / total; } // Rounded down, so only equal pizzas are 100% alike
+};
+
+inline bool operator<(Similarity s1, Similarity s2) { return s1.shared * s2.total < s2.shared * s1.total; }
+inline bool operator>(Similarity s1, Similarity s2) { return s2 < s1; }
+inline bool operator==(Similarity s1, Similarity s2) { return s1.shared * s2.total == s2.shared * s1.total; }
+inline bool operator!=(Similarity s1, Similarity s2) { return !(s1 == s2); }
+
+ToppingMask halvesOf(const ToppingMask& tm); // The halves each topping covers, as bits in the LEFT and RIGHT positions
+// (so an ALL topping sets both, and the ALL bits are always clear)
+
+Similarity similarity(const Pizza& p1, const Pizza& p2);
+Similarity similarity(const Pizza& p1, const ToppingMask& halves1, const Pizza& p2); // For comparing one pizza against many,
+// with the halves of its toppings worked out just once
@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include "pizza.hpp"
+
+// Defines the summaries an approximate session counts its votes in, instead of keeping a tally for every order
+// Both take the same memory however many votes and distinct pizzas stream through them, at the cost of exactness
+
+class HyperLogLog // Estimates how many distinct items it has been shown, to within about 1.6% (one standard error)
+{
+public:
+	static constexpr int precision = 12; // 4096 one-byte registers
+	static constexpr double standard_error = 1.04 / 64; // (1.04 / sqrt(registers))
+
+	void add(std::uint64_t hash); // The hash has to be well mixed, as fingerprint's are
+	std::uint64_t estimate() const;
+	void clear();
+
+private:
+	std::array<std::uint8_t, std::size_t{1} << precision> registers{}; // The longest run of leading zeros seen in each bucket, plus one
+};
+
+class SpaceSaving // Keeps the k pizzas with the most votes, give or take the error of each count
+// Once all k counters are taken, a pizza without one takes over the counter with the fewest votes, and inherits its count
+// as error, so each count is an overestimate by at most its error, and no pizza left out has more votes than the smallest count
+// (which is at most total() / k)
+{
+public:
+	struct Counter
+	{
+		Pizza pizza;
+		std::int64_t count; // The true votes are between count - error and count
+		std::int64_t error;
+	};
+
+	explicit SpaceSaving(std::size_t k);
+
+	void add(const Pizza& p, std::int64_t votes); // (votes can't be negative, since nothing can be taken back out of a summary)
+	std::vector<Counter> top(std::size_t n) const; // The n counters with the most votes, most first
+	std::int64_t total() const; // Every vote seen
+	std::int64_t floor() const; // The most votes a pizza without a counter might have had
+	std::size_t capacity() const;
+	void clear();
+
+private:
+	std::size_t k;
+	std::vector<Counter> counters;
+	std::vector<std::uint32_t> heap; // Counter indices, as a min-heap by count
+	std::vector<std::uint32_t> heap_pos; // Where each counter is in heap
+	std::unordered_multimap<std::uint64_t, std::uint32_t> by_fingerprint; // Maps each counted pizza's fingerprint to its counter
+	std::int64_t seen = 0;
+
+	void siftDown(std::size_t i); // Restores the heap after heap[i]'s count goes up
+	void place(std::size_t i, std::uint32_t c);
+};
+
+struct VoteSketch // What an approximate session keeps in place of its tallies
+{
+	SpaceSaving top;
+	HyperLogLog pizzas; // Every pizza voted on, ordered or not (even with no votes)
+	HyperLogLog voters; // Everyone who has voted BY name (though not what they voted for, so nothing stops them voting again)
+
+	explicit VoteSketch(std::size_t k) : top(k) {}
+
+	void vote(const Pizza& p, std::int64_t amount); // (only a positive amount goes to the top, whose counts only grow)
+	void clear();
+};
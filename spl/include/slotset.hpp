@@ -0,0 +1,74 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "pizza.hpp"
+
+// Defines a compressed set of session slots, laid out like a roaring bitmap
+// The slots are split into chunks of 65536 by their high bits, and only chunks with something in them are stored
+// A sparse chunk keeps the low bits of its slots in a sorted array, and a dense one keeps a bitmap of them,
+// so a set never takes much more than two bytes per slot, and a long run of slots takes an eighth of a byte each
+// Intersecting two sets only visits the chunks they share, and within those, mostly the smaller side
+
+class SlotSet
+{
+public:
+	bool contains(std::size_t slot) const;
+	void insert(std::size_t slot);
+	void erase(std::size_t slot);
+	void clear();
+	std::size_t size() const;
+	bool empty() const;
+	std::size_t first() const; // The lowest slot in the set, which mustn't be empty
+
+	SlotSet& operator&=(const SlotSet& other); // Keeps only the slots that are in both
+	SlotSet& operator|=(const SlotSet& other); // Adds every slot from other
+
+	template<typename F>
+	void forEach(F f) const // Calls f on each slot, in ascending order
+	{
+		forEachWhile([&](std::size_t slot) { f(slot); return true; });
+	}
+
+	template<typename F>
+	void forEachWhile(F f) const // Likewise, but stops as soon as f returns false
+	{
+		for (const Chunk& c : chunks) {
+			std::size_t high = std::size_t{c.key} << 16;
+			if (c.dense()) {
+				for (std::size_t w = 0; w < c.bits.size(); ++w) {
+					for (std::uint64_t word = c.bits[w]; word; word &= word - 1) {
+						if (!f(high | (w * 64 + lowestBit(word)))) return;
+					}
+				}
+			} else {
+				for (std::uint16_t low : c.low) {
+					if (!f(high | low)) return;
+				}
+			}
+		}
+	}
+
+private:
+	struct Chunk
+	{
+		std::uint32_t key; // The high bits that every slot in the chunk shares
+		std::uint32_t count;
+		std::vector<std::uint16_t> low; // The low bits, sorted, while the chunk is sparse
+		std::vector<std::uint64_t> bits; // A bitmap of them once it's dense (only one of the two is in use at a time)
+
+		bool dense() const { return !bits.empty(); }
+		bool contains(std::uint16_t l) const;
+		void densify();
+		void sparsify();
+	};
+
+	static constexpr std::uint32_t denseAbove = 4096; // Past this, a sorted array takes more room than a bitmap
+	static constexpr std::uint32_t sparseBelow = 2048; // (lower, so a chunk on the edge doesn't flip back and forth)
+
+	std::vector<Chunk> chunks; // Sorted by key
+	std::size_t count = 0;
+
+	std::vector<Chunk>::iterator chunkFor(std::uint32_t key);
+	std::vector<Chunk>::const_iterator chunkFor(std::uint32_t key) const;
+};
@@ -3,11 +3,15 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <functional>
+#include <cstddef>
 #include "parsetypes.hpp"
+#include "ballots.hpp"
 
 // Defines the types of statements and how the program processes them 
 
 struct ProgramState;
+namespace transpiler { class Unit; }
 
 class Statement
 {
@@ -15,6 +19,8 @@ private:
 public:
 	virtual int execute(ProgramState& ps) = 0; // The return value is presumably some kind of error code,
 	virtual ~Statement() = 0; // although I do hope we can catch most errors at interpret-time rather than run-time
+	virtual std::string transpile(transpiler::Unit& u) = 0; // Returns a C++ expression that runs the statement against ps,
+	// by calling its function in run directly (see transpiler.hpp)
 };
 inline Statement::~Statement() { }
 
@@ -22,20 +28,23 @@ inline Statement::~Statement() { }
 class StartSession: public Statement
 {
 private: // Whatever the statement is parameterized over
-	std::string name;
+	Symbol name;
 	int reserves; // this should be the amount of pizzas you expect to be ordered, roughly
+	int approximate; // How many pizzas an approximate session keeps vote counts for, or zero for an exact session
 public:
-	StartSession(const std::string& _name, int _reserves) : name{_name}, reserves{_reserves} {}
+	StartSession(Symbol _name, int _reserves, int _approximate) : name{_name}, reserves{_reserves}, approximate{_approximate} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 };
 
 class NameSession: public Statement
 {
 private:
-	std::string name;
+	Symbol name;
 public:
-	NameSession(const std::string& _name) : name{_name} {}
+	NameSession(Symbol _name) : name{_name} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 }; 
 
 class EndSession: public Statement
@@ -44,6 +53,7 @@ private:
 public:
 	EndSession() {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 };
 
 class SaveSession: public Statement
@@ -53,6 +63,7 @@ private:
 public:
 	SaveSession(const std::string& _filepath) : filepath{_filepath} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 }; 
 
 class LoadSession: public Statement
@@ -62,16 +73,29 @@ private:
 public:
 	LoadSession(const std::string& _filepath) : filepath{_filepath} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 }; 
 
+class MergeSession: public Statement
+{
+private:
+	std::string filepath;
+public:
+	MergeSession(const std::string& _filepath) : filepath{_filepath} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
 class AddPizza: public Statement
 {
 private:
 	Pizza p;
-	std::string name;
+	ToppingOrder written;
+	Symbol name;
 public:
-	AddPizza(Pizza _p, const std::string& _name) : p{_p}, name{_name} {}
+	AddPizza(Pizza _p, const ToppingOrder& _written, Symbol _name) : p{_p}, written{_written}, name{_name} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 };  
 
 class RemovePizza: public Statement
@@ -81,8 +105,19 @@ private:
 public:
 	RemovePizza(const PizzaSpecifier& _pspec) : pspec{_pspec} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 }; 
 
+class RemovePizzaWhere: public Statement
+{
+private:
+	Filter where;
+public:
+	RemovePizzaWhere(const Filter& _where) : where{_where} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
 class ViewPizza: public Statement
 {
 private:
@@ -92,16 +127,96 @@ private:
 public:
 	ViewPizza(const PizzaSpecifier& _pspec, bool _details, bool _all) : pspec{_pspec}, details{_details}, all{_all} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 }; 
 
+class ViewPizzaWithTopping: public Statement
+{
+private:
+	ToppingArrangement ta; // Matched exactly, so {Ham} doesn't match {Left: Ham}
+	bool details;
+public:
+	ViewPizzaWithTopping(ToppingArrangement _ta, bool _details) : ta{_ta}, details{_details} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class ViewPizzaNearest: public Statement
+{
+private:
+	Pizza p;
+	int n;
+	bool details;
+public:
+	ViewPizzaNearest(const Pizza& _p, int _n, bool _details) : p{_p}, n{_n}, details{_details} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class ViewPizzaWhere: public Statement
+{
+private:
+	Filter where;
+	bool details;
+public:
+	ViewPizzaWhere(const Filter& _where, bool _details) : where{_where}, details{_details} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class ViewPizzaLike: public Statement
+{
+private:
+	std::string pattern; // '%' matches any run of characters, and '_' any one
+	bool details;
+public:
+	ViewPizzaLike(const std::string& _pattern, bool _details) : pattern{_pattern}, details{_details} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
 class VotePizza: public Statement
 {
 private:
 	PizzaSpecifier pspec;
 	int n;
+	Symbol voter; // Who the vote is from, or empty if it's from no one in particular
 public:
-	VotePizza(const PizzaSpecifier& _pspec, int _n) : pspec{_pspec}, n{_n} {}
+	VotePizza(const PizzaSpecifier& _pspec, int _n, Symbol _voter) : pspec{_pspec}, n{_n}, voter{_voter} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class VotePizzas: public Statement
+{
+private:
+	VoteList votes; // Counted all together, or not at all if any of them is invalid
+public:
+	VotePizzas(const VoteList& _votes) : votes{_votes} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class VotePizzaWhere: public Statement
+{
+private:
+	Filter where;
+	int n;
+public:
+	VotePizzaWhere(const Filter& _where, int _n) : where{_where}, n{_n} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class CastBallot: public Statement
+{
+private:
+	SpecifierList prefs; // Most preferred first, if the ballot is ranked
+	bool ranked;
+public:
+	CastBallot(const SpecifierList& _prefs, bool _ranked) : prefs{_prefs}, ranked{_ranked} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 };
 
 class SelectTopPizza: public Statement
@@ -111,6 +226,41 @@ private:
 public:
 	SelectTopPizza(int _n) : n{_n} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class SelectTopPizzaWhere: public Statement
+{
+private:
+	int n;
+	Filter where;
+public:
+	SelectTopPizzaWhere(int _n, const Filter& _where) : n{_n}, where{_where} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class SelectTopPizzaBy: public Statement
+{
+private:
+	int n;
+	Tally how;
+public:
+	SelectTopPizzaBy(int _n, Tally _how) : n{_n}, how{_how} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class AggregateIngredients: public Statement
+{
+private:
+	int n;
+	bool all; // Whether to count every order, or just the top n
+	bool by_votes;
+public:
+	AggregateIngredients(int _n, bool _all, bool _by_votes) : n{_n}, all{_all}, by_votes{_by_votes} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 };
 
 class ResetSessionVotes: public Statement
@@ -119,6 +269,7 @@ private:
 public:
 	ResetSessionVotes() {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 };
 
 class ResetSession: public Statement
@@ -127,6 +278,7 @@ private:
 public:
 	ResetSession() {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 };
 
 class AlterPizzaAdd: public Statement
@@ -137,6 +289,7 @@ private:
 public:
 	AlterPizzaAdd(const PizzaSpecifier& _pspec, ToppingArrangement _ta) : pspec{_pspec}, ta{_ta} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 };
 
 class AlterPizzaRemove: public Statement
@@ -147,6 +300,7 @@ private:
 public:
 	AlterPizzaRemove(const PizzaSpecifier& _pspec, ToppingArrangement _ta) : pspec{_pspec}, ta{_ta} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 };
 
 class AlterPizzaSetCrust: public Statement
@@ -157,6 +311,7 @@ private:
 public:
 	AlterPizzaSetCrust(const PizzaSpecifier& _pspec, Crust _c) : pspec{_pspec}, c{_c} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 };
 
 class AlterPizzaSetSauce: public Statement
@@ -167,6 +322,7 @@ private:
 public:
 	AlterPizzaSetSauce(const PizzaSpecifier& _pspec, Sauce _s) : pspec{_pspec}, s{_s} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 };
 
 class AlterPizzaSetCheese: public Statement
@@ -177,6 +333,78 @@ private:
 public:
 	AlterPizzaSetCheese(const PizzaSpecifier& _pspec, Cheese _ch) : pspec{_pspec}, ch{_ch} {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class AlterPizzaSetName: public Statement
+{
+private:
+	PizzaSpecifier pspec;
+	Symbol name;
+public:
+	AlterPizzaSetName(const PizzaSpecifier& _pspec, Symbol _name) : pspec{_pspec}, name{_name} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class AlterPizzaWhere: public Statement
+{
+private:
+	Filter where;
+	PizzaElement change; // A topping to add or remove, or the crust, sauce, or cheese to switch to
+	bool removing; // (only means anything for a topping)
+public:
+	AlterPizzaWhere(const Filter& _where, const PizzaElement& _change, bool _removing) : where{_where}, change{_change}, removing{_removing} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class BeginTransaction: public Statement
+{
+private:
+public:
+	BeginTransaction() {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class CommitTransaction: public Statement
+{
+private:
+public:
+	CommitTransaction() {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class RollbackTransaction: public Statement
+{
+private:
+public:
+	RollbackTransaction() {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class ImportScript: public Statement
+{
+private:
+	std::string filepath;
+public:
+	ImportScript(const std::string& _filepath) : filepath{_filepath} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
+};
+
+class RepeatBlock: public Statement
+{
+private:
+	int n;
+	Block body; // Parsed once, however many times it runs
+public:
+	RepeatBlock(int _n, Block _body) : n{_n}, body{_body} {}
+	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 };
 
 class Quit: public Statement
@@ -185,10 +413,64 @@ private:
 public:
 	Quit() {}
 	virtual int execute(ProgramState& ps);
+	virtual std::string transpile(transpiler::Unit& u);
 };
 
-using Program = std::vector<std::unique_ptr<Statement>>;
 int execute(Program& p, ProgramState& ps);
+int execute(int (*script)(ProgramState&), ProgramState& ps); // Likewise, for a program transpiled into script, which runs its
+// statements in order and returns the first error code (setting the program counter before each, as execute would)
+int executeNested(Program& p, ProgramState& ps, std::size_t& reached); // Runs p as part of the current statement
+// (reached is set to the 1-based position of the last statement run, for error reporting)
+
+// The workings of each statement, as a function of what it's parameterized over; each statement's execute calls its own,
+// and a transpiled program calls them one after another with the arguments built in, without any statements at all
+
+namespace run {
+
+	using Body = std::function<int(ProgramState&, std::size_t&)>; // Runs a block or an imported script as part of the current
+	// statement, setting its second argument as executeNested sets reached
+
+	int startSession(ProgramState& ps, Symbol name, int reserves, int approximate);
+	int nameSession(ProgramState& ps, Symbol name);
+	int endSession(ProgramState& ps);
+	int saveSession(ProgramState& ps, const std::string& filepath);
+	int loadSession(ProgramState& ps, const std::string& filepath);
+	int mergeSession(ProgramState& ps, const std::string& filepath);
+	int addPizza(ProgramState& ps, const Pizza& p, const ToppingOrder& written, Symbol name);
+	int removePizza(ProgramState& ps, const PizzaSpecifier& pspec);
+	int removePizzaWhere(ProgramState& ps, const Filter& where);
+	int viewPizza(ProgramState& ps, const PizzaSpecifier& pspec, bool details, bool all);
+	int viewPizzaWithTopping(ProgramState& ps, ToppingArrangement ta, bool details);
+	int viewPizzaNearest(ProgramState& ps, const Pizza& p, int n, bool details);
+	int viewPizzaWhere(ProgramState& ps, const Filter& where, bool details);
+	int viewPizzaLike(ProgramState& ps, const std::string& pattern, bool details);
+	int votePizza(ProgramState& ps, const PizzaSpecifier& pspec, int n, Symbol voter);
+	int votePizzas(ProgramState& ps, const VoteList& votes);
+	int votePizzaWhere(ProgramState& ps, const Filter& where, int n);
+	int castBallot(ProgramState& ps, const SpecifierList& prefs, bool ranked);
+	int selectTopPizza(ProgramState& ps, int n);
+	int selectTopPizzaWhere(ProgramState& ps, int n, const Filter& where);
+	int selectTopPizzaBy(ProgramState& ps, int n, Tally how);
+	int aggregateIngredients(ProgramState& ps, int n, bool all, bool by_votes);
+	int resetSessionVotes(ProgramState& ps);
+	int resetSession(ProgramState& ps);
+	int alterPizzaAdd(ProgramState& ps, const PizzaSpecifier& pspec, ToppingArrangement ta);
+	int alterPizzaRemove(ProgramState& ps, const PizzaSpecifier& pspec, ToppingArrangement ta);
+	int alterPizzaSetCrust(ProgramState& ps, const PizzaSpecifier& pspec, Crust c);
+	int alterPizzaSetSauce(ProgramState& ps, const PizzaSpecifier& pspec, Sauce s);
+	int alterPizzaSetCheese(ProgramState& ps, const PizzaSpecifier& pspec, Cheese ch);
+	int alterPizzaSetName(ProgramState& ps, const PizzaSpecifier& pspec, Symbol name);
+	int alterPizzaWhere(ProgramState& ps, const Filter& where, const PizzaElement& change, bool removing);
+	int beginTransaction(ProgramState& ps);
+	int commitTransaction(ProgramState& ps);
+	int rollbackTransaction(ProgramState& ps);
+	int importScript(ProgramState& ps, const std::string& filepath); // Finds, parses (unless it's cached), and runs the script
+	int importModule(ProgramState& ps, const std::string& filepath, const std::string& path, const Body& module); // Runs the
+	// script at path (which is canonical, and is what filepath named) as module, whose statements have already been found
+	int repeatBlock(ProgramState& ps, int n, const Body& body);
+	int quit(ProgramState& ps);
+
+}
 
 inline std::ostream& operator<<(std::ostream& os, const Program& p)
 {
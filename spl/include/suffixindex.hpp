@@ -0,0 +1,28 @@
+#pragma once
+#include <set>
+#include <vector>
+#include <string_view>
+#include <utility>
+#include <cstdint>
+#include "symbols.hpp"
+
+// Defines the index that LIKE searches order names with
+// It keeps every suffix of every name in sorted order, so the names containing some text are exactly those with a suffix
+// that starts with it, and they can all be found with one binary search and a walk over the matches
+// The suffixes are views into the symbol table, which never moves or frees its text, so they cost no copies
+
+class SuffixIndex
+{
+public:
+	void insert(Symbol name); // Adds every suffix of name, which mustn't be in the index already
+	void erase(Symbol name);
+	void clear();
+
+	std::vector<Symbol> like(std::string_view pattern) const; // Every name in the index that matches pattern, in no particular order
+
+	static bool matches(std::string_view text, std::string_view pattern); // '%' matches any run of characters, and '_' any one
+	// (the comparison is case-sensitive, as with names everywhere else)
+
+private:
+	std::set<std::pair<std::string_view, std::uint32_t>> suffixes; // (suffix, the ID of the symbol it's a suffix of)
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <functional>
+#include <cstdint>
+
+// Defines the symbols that names are interned as
+// Each distinct name is stored once, in a table shared by the whole process, and is identified by a small integer,
+// so names are compared and hashed as integers and a name repeated throughout a script takes no extra memory
+// The table is process-wide rather than per session because names are interned while parsing, before any session exists
+// Entries are never freed; a script can only name as many things as it has string literals
+
+struct Symbol
+{
+	std::uint32_t id = 0; // Symbol 0 is always the empty string, so a default Symbol is the empty name
+
+	static Symbol of(std::string_view text); // Interns text, if it isn't already
+	const std::string& text() const;
+	bool empty() const { return id == 0; }
+};
+
+inline bool operator==(Symbol s1, Symbol s2) { return s1.id == s2.id; }
+inline bool operator!=(Symbol s1, Symbol s2) { return s1.id != s2.id; }
+
+inline std::ostream& operator<<(std::ostream& os, Symbol s) { return os << s.text(); }
+
+template<>
+struct std::hash<Symbol>
+{
+	std::size_t operator()(Symbol s) const noexcept { return s.id; }
+};
@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstddef>
 #include <cctype>
 #include <stdexcept>
 #include <map>
@@ -23,20 +25,44 @@ enum class Keyword
 	SESSION,
 
 	ADD,
+	AGGREGATE,
 	ALTER,
+	AND,
+	APPROVAL,
+	APPROXIMATE,
 	AS,
+	BALLOT,
+	BEGIN,
+	BORDA,
+	BY,
 	CHEESE,
+	COMMIT,
 	CRUST,
+	DAIRYFREE,
 	DEMOCRACY,
 	DETAILS,
 	END,
 	FOR,
 	FROM,
+	GLUTENFREE,
+	HAS,
+	IMPORT,
+	INGREDIENTS,
+	LIKE,
 	LOAD,
+	MERGE,
 	NAME,
+	NEAREST,
+	NOT,
+	OR,
+	PIZZAS,
 	QUIT,
+	RANKED,
 	REMOVE,
+	REPEAT,
 	RESET,
+	ROLLBACK,
+	RUNOFF,
 	SAUCE,
 	SAVE,
 	SELECT,
@@ -46,14 +72,38 @@ enum class Keyword
 	TO,
 	TOP,
 	TOPPING,
+	VEGAN,
+	VEGETARIAN,
 	VIEW,
 	VOTE,
-	VOTES
+	VOTES,
+	WHERE,
+	WITH
 };
 
 class Delimiter // The semicolon which separates statements 
 {}; 
 
+class BlockBegin // The brace which opens a block of statements
+{};
+
+class BlockEnd // The brace which closes a block of statements
+{};
+
+class Comma // The comma which separates the items of a list, e.g. the pizzas on a ballot
+{};
+
+enum class Comparator
+{ // The comparisons that a WHERE clause can make, e.g. VOTES >= (3)
+	BADPARSE = 0,
+
+	LESS,
+	LESSEQUAL,
+	EQUAL,
+	GREATEREQUAL,
+	GREATER
+};
+
 template<typename T>
 using TransTable = std::map<std::string, T>; // A transtable is a mapping from strings to keyword types (T)
 
@@ -71,26 +121,65 @@ T translate(std::string s, const TransTable<T>& tbl)
 	}
 }
 
+template<typename T>
+struct Name // A name for a pizza component, kept in a plain list so that pizza literals can search it at compile time
+{
+	std::string_view text;
+	T value;
+};
+
+template<typename T, std::size_t N>
+TransTable<T> transTableOf(const Name<T> (&names)[N]) // Builds the transtable that the interpreter uses from a list of names
+{
+	TransTable<T> tbl;
+	for (const Name<T>& n : names) tbl.emplace(std::string(n.text), n.value);
+	return tbl;
+}
+
 inline TransTable<Keyword> keyTrans
 {
 	{"PIZZA", Keyword::PIZZA},
 	{"SESSION", Keyword::SESSION},
 
 	{"ADD", Keyword::ADD},
+	{"AGGREGATE", Keyword::AGGREGATE},
 	{"ALTER", Keyword::ALTER},
+	{"AND", Keyword::AND},
+	{"APPROVAL", Keyword::APPROVAL},
+	{"APPROXIMATE", Keyword::APPROXIMATE},
 	{"AS", Keyword::AS},
+	{"BALLOT", Keyword::BALLOT},
+	{"BEGIN", Keyword::BEGIN},
+	{"BORDA", Keyword::BORDA},
+	{"BY", Keyword::BY},
 	{"CHEESE", Keyword::CHEESE},
+	{"COMMIT", Keyword::COMMIT},
 	{"CRUST", Keyword::CRUST},
+	{"DAIRYFREE", Keyword::DAIRYFREE},
 	{"DEMOCRACY", Keyword::DEMOCRACY},
 	{"DETAILS", Keyword::DETAILS},
 	{"END", Keyword::END},
 	{"FOR", Keyword::FOR},
 	{"FROM", Keyword::FROM},
+	{"GLUTENFREE", Keyword::GLUTENFREE},
+	{"HAS", Keyword::HAS},
+	{"IMPORT", Keyword::IMPORT},
+	{"INGREDIENTS", Keyword::INGREDIENTS},
+	{"LIKE", Keyword::LIKE},
 	{"LOAD", Keyword::LOAD},
+	{"MERGE", Keyword::MERGE},
 	{"NAME", Keyword::NAME},
+	{"NEAREST", Keyword::NEAREST},
+	{"NOT", Keyword::NOT},
+	{"OR", Keyword::OR},
+	{"PIZZAS", Keyword::PIZZAS},
 	{"QUIT", Keyword::QUIT},
+	{"RANKED", Keyword::RANKED},
 	{"REMOVE", Keyword::REMOVE},
+	{"REPEAT", Keyword::REPEAT},
 	{"RESET", Keyword::RESET},
+	{"ROLLBACK", Keyword::ROLLBACK},
+	{"RUNOFF", Keyword::RUNOFF},
 	{"SAUCE", Keyword::SAUCE},
 	{"SAVE", Keyword::SAVE},
 	{"SELECT", Keyword::SELECT},
@@ -100,20 +189,34 @@ inline TransTable<Keyword> keyTrans
 	{"TO", Keyword::TO},
 	{"TOP", Keyword::TOP},
 	{"TOPPING", Keyword::TOPPING},
+	{"VEGAN", Keyword::VEGAN},
+	{"VEGETARIAN", Keyword::VEGETARIAN},
 	{"VIEW", Keyword::VIEW},
 	{"VOTE", Keyword::VOTE},
-	{"VOTES", Keyword::VOTES}
+	{"VOTES", Keyword::VOTES},
+	{"WHERE", Keyword::WHERE},
+	{"WITH", Keyword::WITH}
+};
+
+inline TransTable<Comparator> compTrans
+{
+	{"<", Comparator::LESS},
+	{"<=", Comparator::LESSEQUAL},
+	{"=", Comparator::EQUAL},
+	{">=", Comparator::GREATEREQUAL},
+	{">", Comparator::GREATER}
 };
 
-inline TransTable<Crust> crustTrans
+inline constexpr Name<Crust> crustNames[]
 {
 	{"STANDARD", Crust::STANDARD},
 	{"THINCRUST", Crust::THINCRUST},
 	{"THICKCRUST", Crust::THICKCRUST},
 	{"GLUTENFREE", Crust::GLUTENFREE}
 };
+inline TransTable<Crust> crustTrans = transTableOf(crustNames);
 
-inline TransTable<Sauce> sauceTrans
+inline constexpr Name<Sauce> sauceNames[]
 {
 	{"NONE", Sauce::NONE},
 	{"TOMATO", Sauce::TOMATO},
@@ -121,8 +224,9 @@ inline TransTable<Sauce> sauceTrans
 	{"OLIVEOIL", Sauce::OLIVEOIL},
 	{"BBQ", Sauce::BBQ}, {"BARBECUE", Sauce::BBQ}
 };
+inline TransTable<Sauce> sauceTrans = transTableOf(sauceNames);
 
-inline TransTable<Cheese> cheeseTrans
+inline constexpr Name<Cheese> cheeseNames[]
 {
 	{"NONE", Cheese::NONE},
 	{"MOZZARELLA", Cheese::MOZZARELLA},
@@ -130,8 +234,9 @@ inline TransTable<Cheese> cheeseTrans
 	{"TRIPLEMOZZARELLA", Cheese::TRIPLEMOZZARELLA},
 	{"DAIRYFREE", Cheese::DAIRYFREE}
 };
+inline TransTable<Cheese> cheeseTrans = transTableOf(cheeseNames);
 
-inline TransTable<Topping> topTrans
+inline constexpr Name<Topping> topNames[]
 {
 	{"PEPPERONI", Topping::PEPPERONI},
 	{"BACON", Topping::BACON},
@@ -150,7 +255,7 @@ inline TransTable<Topping> topTrans
 	{"BRUSCHETTA", Topping::BRUSCHETTA},
 	{"GARLIC", Topping::GARLIC},
 	{"GREENPEPPERS", Topping::GREENPEPPERS},
-	{"ROASTEDREDREPPERS", Topping::ROASTEDREDPEPPERS},
+	{"ROASTEDREDPEPPERS", Topping::ROASTEDREDPEPPERS}, {"ROASTEDREDREPPERS", Topping::ROASTEDREDPEPPERS},
 	{"HOTPEPPERS", Topping::HOTPEPPERS},
 	{"HOTHONEY", Topping::HOTHONEY},
 	{"MUSHROOMS", Topping::MUSHROOMS}, 
@@ -169,10 +274,12 @@ inline TransTable<Topping> topTrans
 	{"GOATCHEESE", Topping::GOATCHEESE},
 	{"PARMESAN", Topping::PARMESAN}
 };
+inline TransTable<Topping> topTrans = transTableOf(topNames);
 
-inline TransTable<ToppingPosition> posTrans
+inline constexpr Name<ToppingPosition> posNames[]
 {
 	{"LEFT", ToppingPosition::LEFT},
 	{"RIGHT", ToppingPosition::RIGHT},
 	{"ALL", ToppingPosition::ALL}
 };
+inline TransTable<ToppingPosition> posTrans = transTableOf(posNames);
@@ -1,8 +1,11 @@
 #pragma once
 #include <variant>
 #include <vector>
+#include <memory>
 #include <iostream>
 #include "pizza.hpp"
+#include "symbols.hpp"
+#include "filter.hpp"
 #include "syntax.hpp"
 
 // Defines the tokens that make up a statement
@@ -16,12 +19,27 @@ enum class TokenType
 	STRING,
 	PIZZA,
 	PIZZAELEMENT,
-	DELIMITER
+	DELIMITER,
+	BLOCKBEGIN,
+	BLOCKEND,
+	BLOCK,
+	COMPARATOR,
+	FILTER,
+	COMMA,
+	SPECLIST,
+	VOTELIST
 };
 
+class Statement;
+using Program = std::vector<std::unique_ptr<Statement>>;
+using Block = std::shared_ptr<Program>; // The body of a block, which the parser folds into a single token
+
 using PizzaElement = std::variant<Crust, Sauce, Cheese, ToppingArrangement>;
-using PizzaSpecifier = std::variant<int, std::string, Pizza>;
-using TokenValue = std::variant<std::monostate, Keyword, int, std::string, Pizza, PizzaElement, Delimiter>;
+using PizzaSpecifier = std::variant<int, Symbol, Pizza>; // (an order is named by its symbol)
+using SpecifierList = std::vector<PizzaSpecifier>; // A list of pizza specifiers, which the parser folds into a single token
+using VoteList = std::vector<std::pair<PizzaSpecifier, int>>; // A list of pizza specifiers with the votes for each, folded likewise
+using TokenValue = std::variant<std::monostate, Keyword, int, std::string, Pizza, PizzaElement, Delimiter, BlockBegin, BlockEnd, Block,
+	Comparator, Filter, Comma, SpecifierList, VoteList>;
 // note that tokentype's underlying number is exactly the index of the corresponding type
 
 struct Location // Used for error diagnostics
@@ -97,7 +115,7 @@ inline PizzaSpecifier toktospec(const Token& tk)
 		case TokenType::INT:
 			return std::get<int>(tk.value);
 		case TokenType::STRING:
-			return std::get<std::string>(tk.value);
+			return Symbol::of(std::get<std::string>(tk.value));
 		case TokenType::PIZZA:
 			return std::get<Pizza>(tk.value);
 		default:
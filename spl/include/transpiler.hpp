@@ -0,0 +1,67 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <cstddef>
+#include "statement.hpp"
+#include "parsetypes.hpp"
+
+// Defines the functions that turn a parsed program into a standalone C++ translation unit
+// The generated code calls each statement's function in run directly, in order, with its arguments built once as constants,
+// so running it skips preprocessing, tokenizing, lexing, and parsing entirely, and never builds a statement to dispatch on
+// Imported scripts are read in and written out along with the program (so later changes to them aren't seen)
+// It links against every source file but main.cpp.
+
+namespace transpiler {
+
+	std::string literal(int i); // Each of these returns a C++ expression that evaluates to its argument
+	std::string literal(bool b);
+	std::string literal(const std::string& s);
+	std::string literal(Symbol s);
+	std::string literal(Crust c);
+	std::string literal(Sauce s);
+	std::string literal(Cheese ch);
+	std::string literal(ToppingArrangement ta);
+	std::string literal(const Pizza& p);
+	std::string literal(const ToppingOrder& to);
+	std::string literal(const PizzaElement& pze);
+	std::string literal(const PizzaSpecifier& pspec);
+	std::string literal(const SpecifierList& sl);
+	std::string literal(const VoteList& vl);
+	std::string literal(Tally t);
+	std::string literal(const ToppingMask& tm);
+	std::string literal(const Conjunct& c);
+	std::string literal(const Filter& f);
+
+	class Unit // The translation unit being written: the functions that run a program and its blocks, and their constants
+	{
+	public:
+		std::string constant(const std::string& type, const std::string& value); // Returns the name of a constant of type
+		// that is built from the expression value the first time the function being written runs (or of an equal one)
+		std::string nested(Program& p); // Writes a function that runs p as a run::Body, returning its name
+		std::string module(const std::string& path, Program& p); // Likewise for the script at path, which is only written once
+		// however often it's imported (a script that imports itself refers to its own function, and fails when run)
+		void write(Program& p, std::ostream& os, const std::string& origin); // Writes out the whole unit, running p
+
+	private:
+		struct Function
+		{
+			std::string signature;
+			std::map<std::pair<std::string, std::string>, std::string> named; // The name of each constant, by (type, value)
+			std::string constants; // Their declarations
+			std::string body;
+		};
+		std::vector<Function> written;
+		std::vector<Function> writing; // The functions being written, innermost last (a block's is begun during its statement's)
+		std::map<std::string, std::string> modules; // The function for each imported script, by path
+		int functions = 0; // How many names have been given out
+
+		std::string sequence(Program& p, const std::string& name, bool nested); // Writes the functions that run p's statements
+	};
+
+	void emitProgram(Program& p, std::ostream& os, const std::string& origin); // Writes out a translation unit that runs p
+	// (origin is the path of the script p was parsed from, and is only used for the header comment)
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "symbols.hpp"
+
+// Defines the table of what each voter has voted for, for VOTE FOR PIZZA ... BY "voter"
+// It's an open-addressing hash table keyed by the voter's interned name, probed linearly, so each voter takes up
+// one sixteen-byte entry in a single flat array, and finding one usually reads a single cache line
+// Each entry is tagged with the epoch its vote was cast in, like the tallies are, so resetting the votes leaves the table be
+
+class VoterTable
+{
+public:
+	struct Entry
+	{
+		Symbol voter; // (the empty name marks an unused entry, which is why every voter has to have a name)
+		std::uint32_t epoch = 0;
+		int id = 0; // The ID of the order the voter's vote is for, or zero if they haven't got one
+		int amount = 0;
+	};
+
+	Entry& operator[](Symbol voter); // The voter's entry, which is added (without a vote) if they don't have one yet
+	const Entry* find(Symbol voter) const; // Likewise, but null if they don't
+	std::size_t size() const;
+	void clear();
+
+	template<typename F>
+	void forEach(F f) const // Calls f on each voter's entry, in no particular order
+	{
+		for (const Entry& e : entries) {
+			if (!e.voter.empty()) f(e);
+		}
+	}
+
+private:
+	std::vector<Entry> entries; // A power of two of them, at most half full
+	std::size_t used = 0;
+	int bits = 0; // (the log of the number of entries)
+
+	std::size_t home(Symbol voter) const; // Where the search for voter starts
+	void grow();
+};
@@ -0,0 +1,197 @@
+#include "ballots.hpp"
+#include "session.hpp"
+#include <algorithm>
+#include <set>
+
+/* BallotBox */
+
+void BallotBox::cast(const std::vector<int>& ids)
+{
+	prefs.insert(prefs.end(), ids.begin(), ids.end());
+	starts.push_back(static_cast<std::uint32_t>(prefs.size()));
+}
+
+void BallotBox::uncast()
+{
+	starts.pop_back();
+	prefs.resize(starts.back());
+}
+
+void BallotBox::clear()
+{
+	prefs.clear();
+	starts.assign(1, 0);
+}
+
+std::size_t BallotBox::size() const
+{
+	return starts.size() - 1;
+}
+
+std::size_t BallotBox::entries() const
+{
+	return prefs.size();
+}
+
+const int* BallotBox::begin(std::size_t ballot) const
+{
+	return prefs.data() + starts[ballot];
+}
+
+const int* BallotBox::end(std::size_t ballot) const
+{
+	return prefs.data() + starts[ballot + 1];
+}
+
+/* Tallying */
+
+// Every order still in the session that's on some ballot in the box is a candidate, numbered densely in order of ID
+// (which is also slot order), so the tallies below can keep their counts in plain arrays
+// Each preference in the box is matched up with its candidate before tallying, so the work is proportional to the box
+// (times a logarithm), however many orders the session has ever had
+
+struct Candidates
+{
+	std::vector<int> ids; // Maps each candidate number to its ID
+	std::vector<int> of_entry; // Maps each preference in the box, in order, to its candidate number (or -1 if its order is gone)
+	const int* base; // Where the box's preferences start
+
+	int of(const int* p) const { return of_entry[p - base]; } // The candidate number of the preference at p
+};
+
+static Candidates candidatesIn(const OrderSession& os, const BallotBox& box)
+{
+	Candidates c;
+	c.base = box.begin(0);
+	c.ids.assign(c.base, c.base + box.entries());
+	std::sort(c.ids.begin(), c.ids.end());
+	c.ids.erase(std::unique(c.ids.begin(), c.ids.end()), c.ids.end());
+	c.ids.erase(std::remove_if(c.ids.begin(), c.ids.end(), [&](int id) { return os.locate(id) == OrderSession::npos; }), c.ids.end());
+
+	c.of_entry.resize(box.entries());
+	for (std::size_t k = 0; k < box.entries(); ++k) {
+		auto found = std::lower_bound(c.ids.begin(), c.ids.end(), c.base[k]);
+		c.of_entry[k] = (found != c.ids.end() && *found == c.base[k]) ? static_cast<int>(found - c.ids.begin()) : -1;
+	}
+	return c;
+}
+
+static std::vector<std::pair<std::size_t, std::int64_t>> best(const OrderSession& os, const Candidates& c,
+	const std::vector<std::int64_t>& scores, int n) // The n candidates with the highest scores (ties going to the earlier order)
+{
+	std::vector<int> order(c.ids.size());
+	for (std::size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+	auto cutoff = order.begin() + std::min<std::size_t>(n, order.size());
+	std::partial_sort(order.begin(), cutoff, order.end(), [&](int c1, int c2) {
+		return scores[c1] != scores[c2] ? scores[c1] > scores[c2] : c1 < c2;
+	});
+
+	std::vector<std::pair<std::size_t, std::int64_t>> result;
+	for (auto it = order.begin(); it != cutoff; ++it) result.emplace_back(os.locate(c.ids[*it]), scores[*it]);
+	return result;
+}
+
+static std::vector<std::pair<std::size_t, std::int64_t>> runoff(const OrderSession& os, const BallotBox& box, int n)
+{
+	// Each ballot counts for the first candidate on it that hasn't been eliminated, and the ballots counting for each
+	// candidate are chained together, so eliminating a candidate only revisits the ballots that were counting for it
+	// Each ballot moves down its list at most once per preference, so all the rounds together take time linear in the box
+	// (plus a logarithm per candidate whose count changes in a round, for keeping the candidates in order)
+
+	Candidates c = candidatesIn(os, box);
+	std::size_t cands = c.ids.size();
+	std::vector<std::int64_t> count(cands, 0);
+	std::vector<bool> out(cands, false);
+	std::vector<std::uint32_t> at(box.size()); // How far down its list each ballot is
+	constexpr std::uint32_t none = static_cast<std::uint32_t>(-1);
+	std::vector<std::uint32_t> first(cands, none), next(box.size(), none); // The chain of ballots counting for each candidate
+
+	auto place = [&](std::uint32_t b) -> int { // Moves ballot b down to its next candidate still standing, and counts it there
+		const int* p = box.begin(b) + at[b];
+		for (; p != box.end(b); ++p) {
+			int cand = c.of(p);
+			if (cand >= 0 && !out[cand]) break;
+		}
+		at[b] = static_cast<std::uint32_t>(p - box.begin(b));
+		if (p == box.end(b)) return -1; // (the ballot is exhausted)
+		int cand = c.of(p);
+		next[b] = first[cand];
+		first[cand] = b;
+		++count[cand];
+		return cand;
+	};
+
+	for (std::uint32_t b = 0; b < box.size(); ++b) place(b);
+
+	std::set<std::pair<std::int64_t, int>> standing; // (count, -candidate), so the first one is the next to go, with the later
+	for (std::size_t i = 0; i < cands; ++i) standing.emplace(count[i], -static_cast<int>(i)); // order losing a tie
+	std::vector<std::int64_t> score(cands, 0); // Each candidate's count in the round it was eliminated
+	std::vector<std::int64_t> had(cands, -1); // What each candidate that gained ballots this round had before it did
+	std::vector<int> gained;
+
+	while (!standing.empty()) {
+		auto [votes, neg] = *standing.begin();
+		int loser = -neg;
+		standing.erase(standing.begin());
+		out[loser] = true;
+		score[loser] = votes;
+
+		for (std::uint32_t b = first[loser]; b != none;) {
+			std::uint32_t after = next[b];
+			int cand = place(b);
+			if (cand >= 0 && had[cand] < 0) {
+				had[cand] = count[cand] - 1;
+				gained.push_back(cand);
+			}
+			b = after;
+		}
+		for (int cand : gained) {
+			standing.erase({had[cand], -cand});
+			standing.emplace(count[cand], -cand);
+			had[cand] = -1;
+		}
+		gained.clear();
+	}
+
+	// The counts never go down, so the candidates were eliminated in order of score (and among equal scores, from the
+	// later order to the earlier), and ranking them by score ranks them in reverse order of elimination
+
+	return best(os, c, score, n);
+}
+
+static std::vector<std::pair<std::size_t, std::int64_t>> borda(const OrderSession& os, const BallotBox& box, int n)
+{
+	Candidates c = candidatesIn(os, box);
+	std::vector<std::int64_t> score(c.ids.size(), 0);
+	for (std::size_t b = 0; b < box.size(); ++b) {
+		std::int64_t m = 0; // (orders removed since the ballot was cast don't count towards m)
+		for (const int* p = box.begin(b); p != box.end(b); ++p) {
+			if (c.of(p) >= 0) ++m;
+		}
+		for (const int* p = box.begin(b); p != box.end(b); ++p) {
+			if (c.of(p) >= 0) score[c.of(p)] += m--;
+		}
+	}
+	return best(os, c, score, n);
+}
+
+static std::vector<std::pair<std::size_t, std::int64_t>> approval(const OrderSession& os, const BallotBox& box, int n)
+{
+	Candidates c = candidatesIn(os, box);
+	std::vector<std::int64_t> score(c.ids.size(), 0);
+	for (std::size_t b = 0; b < box.size(); ++b) {
+		for (const int* p = box.begin(b); p != box.end(b); ++p) {
+			if (c.of(p) >= 0) ++score[c.of(p)];
+		}
+	}
+	return best(os, c, score, n);
+}
+
+std::vector<std::pair<std::size_t, std::int64_t>> OrderSession::standings(Tally how, int n) const
+{
+	switch (how) {
+		case Tally::RUNOFF: return runoff(*this, ranked_ballots, n);
+		case Tally::BORDA: return borda(*this, ranked_ballots, n);
+		default: return approval(*this, approval_ballots, n);
+	}
+}
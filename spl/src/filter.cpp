@@ -0,0 +1,154 @@
+#include "filter.hpp"
+#include "session.hpp"
+#include <algorithm>
+
+static bool bitIn(std::uint8_t allowed, int value) { return (allowed >> value) & 1; }
+
+bool Conjunct::fits(const Pizza& p) const
+{
+	const ToppingMask& m = p.toppings.mask();
+	return (m[0] & all[0]) == all[0] && (m[1] & all[1]) == all[1]
+		&& !(m[0] & none[0]) && !(m[1] & none[1])
+		&& (!meat || (m[0] & meatMask))
+		&& bitIn(crusts, static_cast<int>(p.crust))
+		&& bitIn(sauces, static_cast<int>(p.sauce))
+		&& bitIn(cheeses, static_cast<int>(p.cheese));
+}
+
+bool Conjunct::onlyPizza() const
+{
+	return min_votes == INT64_MIN && max_votes == INT64_MAX && !name && not_names.empty() && !never;
+}
+
+bool Conjunct::satisfiable() const
+{
+	if (never || (all[0] & none[0]) || (all[1] & none[1])) return false;
+	if (meat && (none[0] & meatMask) == meatMask) return false;
+	if (!crusts || !sauces || !cheeses || min_votes > max_votes) return false;
+	return !name || std::find(not_names.begin(), not_names.end(), *name) == not_names.end();
+}
+
+Conjunct operator&(const Conjunct& c1, const Conjunct& c2)
+{
+	Conjunct both = c1;
+	for (std::size_t w = 0; w < both.all.size(); ++w) {
+		both.all[w] |= c2.all[w];
+		both.none[w] |= c2.none[w];
+	}
+	both.meat = c1.meat || c2.meat;
+	both.crusts &= c2.crusts;
+	both.sauces &= c2.sauces;
+	both.cheeses &= c2.cheeses;
+	both.min_votes = std::max(c1.min_votes, c2.min_votes);
+	both.max_votes = std::min(c1.max_votes, c2.max_votes);
+	if (c2.name) {
+		if (both.name && *both.name != *c2.name) both.never = true; // no order has two names
+		both.name = c2.name;
+	}
+	both.not_names.insert(both.not_names.end(), c2.not_names.begin(), c2.not_names.end());
+	both.never = both.never || c2.never;
+	return both;
+}
+
+Filter operator&&(const Filter& f1, const Filter& f2)
+{
+	Filter both;
+	for (const Conjunct& c1 : f1.conjuncts) {
+		for (const Conjunct& c2 : f2.conjuncts) {
+			Conjunct c = c1 & c2;
+			if (c.satisfiable()) both.conjuncts.push_back(std::move(c));
+		}
+	}
+	return both;
+}
+
+Filter operator||(const Filter& f1, const Filter& f2)
+{
+	Filter either = f1;
+	either.conjuncts.insert(either.conjuncts.end(), f2.conjuncts.begin(), f2.conjuncts.end());
+	return either;
+}
+
+static bool admits(const Conjunct& c, const OrderSession& os, std::size_t slot) // The conditions that aren't on the pizza
+{
+	if (c.never) return false;
+	std::int64_t votes = os.tally(slot);
+	if (votes < c.min_votes || votes > c.max_votes) return false;
+	if (c.name && os.names[slot] != *c.name) return false;
+	return std::find(c.not_names.begin(), c.not_names.end(), os.names[slot]) == c.not_names.end();
+}
+
+bool Filter::onVotes() const
+{
+	return std::any_of(conjuncts.begin(), conjuncts.end(), [](const Conjunct& c) {
+		return c.min_votes != INT64_MIN || c.max_votes != INT64_MAX;
+	});
+}
+
+bool Filter::matches(const OrderSession& os, std::size_t slot) const
+{
+	if (!os.live[slot]) return false;
+	return std::any_of(conjuncts.begin(), conjuncts.end(), [&](const Conjunct& c) {
+		return c.fits(os.pizza(slot)) && admits(c, os, slot);
+	});
+}
+
+SlotSet Filter::select(const OrderSession& os) const
+{
+	SlotSet matched;
+	if (conjuncts.empty()) return matched;
+
+	bool indexed = std::all_of(conjuncts.begin(), conjuncts.end(), [](const Conjunct& c) { return c.all[0] || c.all[1]; });
+
+	if (indexed) { // every conjunct needs some topping, so only the orders with those toppings need to be looked at
+
+		for (const Conjunct& c : conjuncts) {
+			std::vector<const SlotSet*> needed;
+			for (std::size_t bit = 0; bit < ToppingSet::capacity; ++bit) {
+				if ((c.all[bit / 64] >> (bit % 64)) & 1) needed.push_back(&os.withTopping(ToppingSet::arrangementOf(bit)));
+			}
+			std::sort(needed.begin(), needed.end(), [](const SlotSet* s1, const SlotSet* s2) { return s1->size() < s2->size(); });
+
+			SlotSet candidates = *needed.front(); // starting from the rarest topping keeps the intersections small
+			for (auto s = std::next(needed.begin()); s != needed.end() && !candidates.empty(); ++s) candidates &= **s;
+
+			SlotSet met;
+			candidates.forEach([&](std::size_t slot) {
+				if (c.fits(os.pizza(slot)) && admits(c, os, slot)) met.insert(slot);
+			});
+			matched |= met;
+		}
+
+	} else { // otherwise, it's a pass over every order, but a cheap one
+
+		std::vector<std::uint64_t> fitting(os.pool.capacity()); // bit i is set if the pizza meets conjunct i's pizza conditions
+		std::uint64_t pizza_only = 0; // the conjuncts that an order meets just by having a pizza that fits
+		for (std::size_t i = 0; i < conjuncts.size(); ++i) {
+			if (conjuncts[i].onlyPizza()) pizza_only |= std::uint64_t{1} << i;
+		}
+		for (PizzaRef ref = 0; ref < os.pool.capacity(); ++ref) { // (vacant entries are harmless, since nothing refers to them)
+			for (std::size_t i = 0; i < conjuncts.size(); ++i) {
+				if (conjuncts[i].fits(os.pool[ref])) fitting[ref] |= std::uint64_t{1} << i;
+			}
+		}
+
+		for (std::size_t slot = 0; slot < os.slots(); ++slot) {
+			if (!os.live[slot]) continue;
+			std::uint64_t fits = fitting[os.pizza_refs[slot]];
+			if (!fits) continue;
+			if (fits & pizza_only) {
+				matched.insert(slot);
+				continue;
+			}
+			for (; fits; fits &= fits - 1) {
+				if (admits(conjuncts[lowestBit(fits)], os, slot)) {
+					matched.insert(slot);
+					break;
+				}
+			}
+		}
+
+	}
+
+	return matched;
+}
@@ -1,4 +1,5 @@
 #include "grammar.hpp"
+#include "parser.hpp"
 
 AssocList<Signature, StatementAssembler>::iterator Grammar::findSigPair(const TokenList& tl)
 {
@@ -28,26 +29,27 @@ std::unique_ptr<Statement> Grammar::makeStatement(const TokenList& tl)
 
 /* Definition of the current Grammars */
 
+static constexpr int expectedPizzas = 30; // (shared by every grammar that starts sessions)
+
 Grammar grammars::SPL_1() { 
 
 	using FAIL = BadParse; // Throw a BadParse if invalid
 
 	Grammar g;
-	constexpr int expectedPizzas = 30;
 
 	g
 
 	.addSignature({Keyword::START, Keyword::SESSION}, 
 	[](const TokenList& tl) { // START SESSION
-		return std::unique_ptr<Statement>(new StartSession("", expectedPizzas)); 
+		return std::unique_ptr<Statement>(new StartSession(Symbol{}, expectedPizzas, 0)); 
 	})
 	.addSignature({Keyword::START, Keyword::SESSION, Keyword::AS, TokenType::STRING}, 
 	[](const TokenList& tl) { // START SESSION AS "string"
-		return std::unique_ptr<Statement>(new StartSession(std::get<std::string>(tl[3].value), expectedPizzas));
+		return std::unique_ptr<Statement>(new StartSession(Symbol::of(std::get<std::string>(tl[3].value)), expectedPizzas, 0));
 	})
 	.addSignature({Keyword::NAME, Keyword::SESSION, TokenType::STRING}, 
 	[](const TokenList& tl) { // NAME SESSION "string"
-		return std::unique_ptr<Statement>(new NameSession(std::get<std::string>(tl[2].value)));
+		return std::unique_ptr<Statement>(new NameSession(Symbol::of(std::get<std::string>(tl[2].value))));
 	})
 	.addSignature({Keyword::END, Keyword::SESSION},
 	[](const TokenList& tl) { // END SESSION
@@ -66,11 +68,11 @@ Grammar grammars::SPL_1() {
 
 	.addSignature({Keyword::ADD, Keyword::PIZZA, TokenType::PIZZA}, 
 	[](const TokenList& tl) { // ADD PIZZA [pizza]
-		return std::unique_ptr<Statement>(new AddPizza(std::get<Pizza>(tl[2].value), ""));
+		return std::unique_ptr<Statement>(new AddPizza(std::get<Pizza>(tl[2].value), parser::writtenToppings(tl[2].data.str), Symbol{}));
 	})
 	.addSignature({Keyword::ADD, Keyword::PIZZA, TokenType::PIZZA, Keyword::AS, TokenType::STRING},
 	[](const TokenList& tl) { // ADD PIZZA [pizza] AS "string"
-		return std::unique_ptr<Statement>(new AddPizza(std::get<Pizza>(tl[2].value), std::get<std::string>(tl[4].value)));
+		return std::unique_ptr<Statement>(new AddPizza(std::get<Pizza>(tl[2].value), parser::writtenToppings(tl[2].data.str), Symbol::of(std::get<std::string>(tl[4].value))));
 	})
 	.addSignature({Keyword::REMOVE, Keyword::PIZZA, SignatureToken::PSPEC}, 
 	[](const TokenList& tl) { // REMOVE PIZZA <pizza specifier>
@@ -96,15 +98,15 @@ Grammar grammars::SPL_1() {
 
 	.addSignature({Keyword::VOTE, Keyword::FOR, Keyword::PIZZA, SignatureToken::PSPEC}, 
 	[](const TokenList& tl) { // VOTE FOR PIZZA <pizza specifier>
-		return std::unique_ptr<Statement>(new VotePizza(toktospec(tl[3]), 1));
+		return std::unique_ptr<Statement>(new VotePizza(toktospec(tl[3]), 1, Symbol{}));
 	})
 	.addSignature({Keyword::VOTE, Keyword::FOR, Keyword::PIZZA, SignatureToken::PSPEC, TokenType::INT}, 
 	[](const TokenList& tl) { // VOTE FOR PIZZA <pizza specifier> (int)
-		return std::unique_ptr<Statement>(new VotePizza(toktospec(tl[3]), std::get<int>(tl[4].value)));
+		return std::unique_ptr<Statement>(new VotePizza(toktospec(tl[3]), std::get<int>(tl[4].value), Symbol{}));
 	})
 	.addSignature({Keyword::SUBVERT, Keyword::DEMOCRACY, Keyword::FOR, Keyword::PIZZA, SignatureToken::PSPEC}, 
 	[](const TokenList& tl) { // SUBVERT DEMOCRACY FOR PIZZA <pizza specifier>
-		return std::unique_ptr<Statement>(new VotePizza(toktospec(tl[4]), 9999));
+		return std::unique_ptr<Statement>(new VotePizza(toktospec(tl[4]), 9999, Symbol{}));
 	})
 
 	.addSignature({Keyword::SELECT, Keyword::TOP, TokenType::INT, Keyword::PIZZA},
@@ -180,9 +182,231 @@ Grammar grammars::SPL_1() {
 
 Grammar grammars::SPL_1_1()
 {
+	using FAIL = BadParse;
+
 	Grammar g = SPL_1();
 
-	// add new features...
+	g
+
+	.addSignature({Keyword::BEGIN},
+	[](const TokenList& tl) { // BEGIN
+		return std::unique_ptr<Statement>(new BeginTransaction());
+	})
+	.addSignature({Keyword::COMMIT},
+	[](const TokenList& tl) { // COMMIT
+		return std::unique_ptr<Statement>(new CommitTransaction());
+	})
+	.addSignature({Keyword::ROLLBACK},
+	[](const TokenList& tl) { // ROLLBACK
+		return std::unique_ptr<Statement>(new RollbackTransaction());
+	})
+
+	.addSignature({Keyword::IMPORT, TokenType::STRING},
+	[](const TokenList& tl) { // IMPORT "string"
+		return std::unique_ptr<Statement>(new ImportScript(std::get<std::string>(tl[1].value)));
+	})
+
+	.addSignature({Keyword::REPEAT, TokenType::INT, TokenType::BLOCK},
+	[](const TokenList& tl) { // REPEAT (int) { statements }
+		return std::unique_ptr<Statement>(new RepeatBlock(std::get<int>(tl[1].value), std::get<Block>(tl[2].value)));
+	})
+
+	.addSignature({Keyword::ALTER, Keyword::PIZZA, SignatureToken::PSPEC, Keyword::SET, 
+		Keyword::NAME, TokenType::STRING},
+	[](const TokenList& tl) { // ALTER PIZZA <pizza specifier> SET NAME "string"
+		return std::unique_ptr<Statement>(new AlterPizzaSetName(toktospec(tl[2]), Symbol::of(std::get<std::string>(tl[5].value))));
+	})
+
+	.addSignature({Keyword::VIEW, Keyword::PIZZA, Keyword::WITH, Keyword::TOPPING, TokenType::PIZZAELEMENT},
+	[](const TokenList& tl) { // VIEW PIZZA WITH TOPPING {pizza element}
+		if (std::holds_alternative<ToppingArrangement>(std::get<PizzaElement>(tl[4].value))) {
+			return std::unique_ptr<Statement>(new ViewPizzaWithTopping(std::get<ToppingArrangement>(std::get<PizzaElement>(tl[4].value)), false));
+		} else {
+			throw FAIL(WRONG_PIZZA_COMPONENT, tl[4].data.loc, tl[4].data.str, "Expected a topping arrangement");
+		}
+	})
+	.addSignature({Keyword::VIEW, Keyword::PIZZA, Keyword::WITH, Keyword::TOPPING, 
+		TokenType::PIZZAELEMENT, Keyword::DETAILS},
+	[](const TokenList& tl) { // VIEW PIZZA WITH TOPPING {pizza element} DETAILS
+		if (std::holds_alternative<ToppingArrangement>(std::get<PizzaElement>(tl[4].value))) {
+			return std::unique_ptr<Statement>(new ViewPizzaWithTopping(std::get<ToppingArrangement>(std::get<PizzaElement>(tl[4].value)), true));
+		} else {
+			throw FAIL(WRONG_PIZZA_COMPONENT, tl[4].data.loc, tl[4].data.str, "Expected a topping arrangement");
+		}
+	})
+
+	.addSignature({Keyword::VIEW, Keyword::PIZZA, Keyword::LIKE, TokenType::STRING},
+	[](const TokenList& tl) { // VIEW PIZZA LIKE "pattern"
+		return std::unique_ptr<Statement>(new ViewPizzaLike(std::get<std::string>(tl[3].value), false));
+	})
+	.addSignature({Keyword::VIEW, Keyword::PIZZA, Keyword::LIKE, TokenType::STRING, Keyword::DETAILS},
+	[](const TokenList& tl) { // VIEW PIZZA LIKE "pattern" DETAILS
+		return std::unique_ptr<Statement>(new ViewPizzaLike(std::get<std::string>(tl[3].value), true));
+	})
+
+	.addSignature({Keyword::VIEW, Keyword::PIZZA, Keyword::NEAREST, TokenType::PIZZA, TokenType::INT},
+	[](const TokenList& tl) { // VIEW PIZZA NEAREST [pizza] (int)
+		return std::unique_ptr<Statement>(new ViewPizzaNearest(std::get<Pizza>(tl[3].value), std::get<int>(tl[4].value), false));
+	})
+	.addSignature({Keyword::VIEW, Keyword::PIZZA, Keyword::NEAREST, TokenType::PIZZA, 
+		TokenType::INT, Keyword::DETAILS},
+	[](const TokenList& tl) { // VIEW PIZZA NEAREST [pizza] (int) DETAILS
+		return std::unique_ptr<Statement>(new ViewPizzaNearest(std::get<Pizza>(tl[3].value), std::get<int>(tl[4].value), true));
+	})
+
+	.addSignature({Keyword::VIEW, Keyword::PIZZA, TokenType::FILTER},
+	[](const TokenList& tl) { // VIEW PIZZA WHERE <conditions>
+		return std::unique_ptr<Statement>(new ViewPizzaWhere(std::get<Filter>(tl[2].value), false));
+	})
+	.addSignature({Keyword::VIEW, Keyword::PIZZA, TokenType::FILTER, Keyword::DETAILS},
+	[](const TokenList& tl) { // VIEW PIZZA WHERE <conditions> DETAILS
+		return std::unique_ptr<Statement>(new ViewPizzaWhere(std::get<Filter>(tl[2].value), true));
+	})
+	.addSignature({Keyword::SELECT, Keyword::TOP, TokenType::INT, Keyword::PIZZA, TokenType::FILTER},
+	[](const TokenList& tl) { // SELECT TOP (int) PIZZA WHERE <conditions>
+		return std::unique_ptr<Statement>(new SelectTopPizzaWhere(std::get<int>(tl[2].value), std::get<Filter>(tl[4].value)));
+	})
+
+	.addSignature({Keyword::REMOVE, Keyword::PIZZA, TokenType::FILTER},
+	[](const TokenList& tl) { // REMOVE PIZZA WHERE <conditions>
+		return std::unique_ptr<Statement>(new RemovePizzaWhere(std::get<Filter>(tl[2].value)));
+	})
+	.addSignature({Keyword::VOTE, Keyword::FOR, Keyword::PIZZA, TokenType::FILTER},
+	[](const TokenList& tl) { // VOTE FOR PIZZA WHERE <conditions>
+		return std::unique_ptr<Statement>(new VotePizzaWhere(std::get<Filter>(tl[3].value), 1));
+	})
+	.addSignature({Keyword::VOTE, Keyword::FOR, Keyword::PIZZA, TokenType::FILTER, TokenType::INT},
+	[](const TokenList& tl) { // VOTE FOR PIZZA WHERE <conditions> (int)
+		return std::unique_ptr<Statement>(new VotePizzaWhere(std::get<Filter>(tl[3].value), std::get<int>(tl[4].value)));
+	})
+	.addSignature({Keyword::ALTER, Keyword::PIZZA, TokenType::FILTER, Keyword::ADD, 
+		Keyword::TOPPING, TokenType::PIZZAELEMENT},
+	[](const TokenList& tl) { // ALTER PIZZA WHERE <conditions> ADD TOPPING {pizza element}
+		if (std::holds_alternative<ToppingArrangement>(std::get<PizzaElement>(tl[5].value))) {
+			return std::unique_ptr<Statement>(new AlterPizzaWhere(std::get<Filter>(tl[2].value), std::get<PizzaElement>(tl[5].value), false));
+		} else {
+			throw FAIL(WRONG_PIZZA_COMPONENT, tl[5].data.loc, tl[5].data.str, "Expected a topping arrangement");
+		}
+	})
+	.addSignature({Keyword::ALTER, Keyword::PIZZA, TokenType::FILTER, Keyword::REMOVE, 
+		Keyword::TOPPING, TokenType::PIZZAELEMENT},
+	[](const TokenList& tl) { // ALTER PIZZA WHERE <conditions> REMOVE TOPPING {pizza element}
+		if (std::holds_alternative<ToppingArrangement>(std::get<PizzaElement>(tl[5].value))) {
+			return std::unique_ptr<Statement>(new AlterPizzaWhere(std::get<Filter>(tl[2].value), std::get<PizzaElement>(tl[5].value), true));
+		} else {
+			throw FAIL(WRONG_PIZZA_COMPONENT, tl[5].data.loc, tl[5].data.str, "Expected a topping arrangement");
+		}
+	})
+	.addSignature({Keyword::ALTER, Keyword::PIZZA, TokenType::FILTER, Keyword::SET, 
+		Keyword::CRUST, TokenType::PIZZAELEMENT},
+	[](const TokenList& tl) { // ALTER PIZZA WHERE <conditions> SET CRUST {pizza element}
+		if (std::holds_alternative<Crust>(std::get<PizzaElement>(tl[5].value))) {
+			return std::unique_ptr<Statement>(new AlterPizzaWhere(std::get<Filter>(tl[2].value), std::get<PizzaElement>(tl[5].value), false));
+		} else {
+			throw FAIL(WRONG_PIZZA_COMPONENT, tl[5].data.loc, tl[5].data.str, "Expected a crust");
+		}
+	})
+	.addSignature({Keyword::ALTER, Keyword::PIZZA, TokenType::FILTER, Keyword::SET, 
+		Keyword::SAUCE, TokenType::PIZZAELEMENT},
+	[](const TokenList& tl) { // ALTER PIZZA WHERE <conditions> SET SAUCE {pizza element}
+		if (std::holds_alternative<Sauce>(std::get<PizzaElement>(tl[5].value))) {
+			return std::unique_ptr<Statement>(new AlterPizzaWhere(std::get<Filter>(tl[2].value), std::get<PizzaElement>(tl[5].value), false));
+		} else {
+			throw FAIL(WRONG_PIZZA_COMPONENT, tl[5].data.loc, tl[5].data.str, "Expected a sauce");
+		}
+	})
+	.addSignature({Keyword::ALTER, Keyword::PIZZA, TokenType::FILTER, Keyword::SET, 
+		Keyword::CHEESE, TokenType::PIZZAELEMENT},
+	[](const TokenList& tl) { // ALTER PIZZA WHERE <conditions> SET CHEESE {pizza element}
+		if (std::holds_alternative<Cheese>(std::get<PizzaElement>(tl[5].value))) {
+			return std::unique_ptr<Statement>(new AlterPizzaWhere(std::get<Filter>(tl[2].value), std::get<PizzaElement>(tl[5].value), false));
+		} else {
+			throw FAIL(WRONG_PIZZA_COMPONENT, tl[5].data.loc, tl[5].data.str, "Expected a cheese");
+		}
+	})
+
+	.addSignature({Keyword::MERGE, Keyword::SESSION, Keyword::FROM, TokenType::STRING},
+	[](const TokenList& tl) { // MERGE SESSION FROM "string"
+		return std::unique_ptr<Statement>(new MergeSession(std::get<std::string>(tl[3].value)));
+	})
+
+	.addSignature({Keyword::AGGREGATE, Keyword::INGREDIENTS},
+	[](const TokenList& tl) { // AGGREGATE INGREDIENTS
+		return std::unique_ptr<Statement>(new AggregateIngredients(0, true, false));
+	})
+	.addSignature({Keyword::AGGREGATE, Keyword::INGREDIENTS, Keyword::FOR, Keyword::TOP, TokenType::INT},
+	[](const TokenList& tl) { // AGGREGATE INGREDIENTS FOR TOP (int)
+		return std::unique_ptr<Statement>(new AggregateIngredients(std::get<int>(tl[4].value), false, false));
+	})
+	.addSignature({Keyword::AGGREGATE, Keyword::INGREDIENTS, Keyword::BY, Keyword::VOTES},
+	[](const TokenList& tl) { // AGGREGATE INGREDIENTS BY VOTES
+		return std::unique_ptr<Statement>(new AggregateIngredients(0, true, true));
+	})
+	.addSignature({Keyword::AGGREGATE, Keyword::INGREDIENTS, Keyword::BY, Keyword::VOTES, 
+		Keyword::FOR, Keyword::TOP, TokenType::INT},
+	[](const TokenList& tl) { // AGGREGATE INGREDIENTS BY VOTES FOR TOP (int)
+		return std::unique_ptr<Statement>(new AggregateIngredients(std::get<int>(tl[6].value), false, true));
+	})
+
+	.addSignature({Keyword::START, Keyword::SESSION, Keyword::APPROXIMATE, TokenType::INT},
+	[](const TokenList& tl) { // START SESSION APPROXIMATE (int)
+		if (std::get<int>(tl[3].value) < 1) {
+			throw FAIL(INVALID_INT, tl[3].data.loc, tl[3].data.str, "An approximate session has to count votes for at least one pizza");
+		}
+		return std::unique_ptr<Statement>(new StartSession(Symbol{}, expectedPizzas, std::get<int>(tl[3].value)));
+	})
+	.addSignature({Keyword::START, Keyword::SESSION, Keyword::AS, TokenType::STRING,
+		Keyword::APPROXIMATE, TokenType::INT},
+	[](const TokenList& tl) { // START SESSION AS "string" APPROXIMATE (int)
+		if (std::get<int>(tl[5].value) < 1) {
+			throw FAIL(INVALID_INT, tl[5].data.loc, tl[5].data.str, "An approximate session has to count votes for at least one pizza");
+		}
+		return std::unique_ptr<Statement>(new StartSession(Symbol::of(std::get<std::string>(tl[3].value)), expectedPizzas,
+			std::get<int>(tl[5].value)));
+	})
+
+	.addSignature({Keyword::BALLOT, Keyword::RANKED, TokenType::SPECLIST},
+	[](const TokenList& tl) { // BALLOT RANKED <pizza specifier>, <pizza specifier>, ...
+		return std::unique_ptr<Statement>(new CastBallot(std::get<SpecifierList>(tl[2].value), true));
+	})
+	.addSignature({Keyword::BALLOT, Keyword::APPROVAL, TokenType::SPECLIST},
+	[](const TokenList& tl) { // BALLOT APPROVAL <pizza specifier>, <pizza specifier>, ...
+		return std::unique_ptr<Statement>(new CastBallot(std::get<SpecifierList>(tl[2].value), false));
+	})
+	.addSignature({Keyword::SELECT, Keyword::TOP, TokenType::INT, Keyword::PIZZA,
+		Keyword::BY, Keyword::RUNOFF},
+	[](const TokenList& tl) { // SELECT TOP (int) PIZZA BY RUNOFF
+		return std::unique_ptr<Statement>(new SelectTopPizzaBy(std::get<int>(tl[2].value), Tally::RUNOFF));
+	})
+	.addSignature({Keyword::SELECT, Keyword::TOP, TokenType::INT, Keyword::PIZZA,
+		Keyword::BY, Keyword::BORDA},
+	[](const TokenList& tl) { // SELECT TOP (int) PIZZA BY BORDA
+		return std::unique_ptr<Statement>(new SelectTopPizzaBy(std::get<int>(tl[2].value), Tally::BORDA));
+	})
+	.addSignature({Keyword::SELECT, Keyword::TOP, TokenType::INT, Keyword::PIZZA,
+		Keyword::BY, Keyword::APPROVAL},
+	[](const TokenList& tl) { // SELECT TOP (int) PIZZA BY APPROVAL
+		return std::unique_ptr<Statement>(new SelectTopPizzaBy(std::get<int>(tl[2].value), Tally::APPROVAL));
+	})
+
+	.addSignature({Keyword::VOTE, Keyword::FOR, Keyword::PIZZA, SignatureToken::PSPEC, 
+		Keyword::BY, TokenType::STRING},
+	[](const TokenList& tl) { // VOTE FOR PIZZA <pizza specifier> BY "string"
+		if (std::get<std::string>(tl[5].value).empty()) throw FAIL(INVALID_STRING, tl[5].data.loc, tl[5].data.str, "A voter has to have a name");
+		return std::unique_ptr<Statement>(new VotePizza(toktospec(tl[3]), 1, Symbol::of(std::get<std::string>(tl[5].value))));
+	})
+	.addSignature({Keyword::VOTE, Keyword::FOR, Keyword::PIZZA, SignatureToken::PSPEC, 
+		TokenType::INT, Keyword::BY, TokenType::STRING},
+	[](const TokenList& tl) { // VOTE FOR PIZZA <pizza specifier> (int) BY "string"
+		if (std::get<std::string>(tl[6].value).empty()) throw FAIL(INVALID_STRING, tl[6].data.loc, tl[6].data.str, "A voter has to have a name");
+		return std::unique_ptr<Statement>(new VotePizza(toktospec(tl[3]), std::get<int>(tl[4].value), 
+			Symbol::of(std::get<std::string>(tl[6].value))));
+	})
+
+	.addSignature({Keyword::VOTE, Keyword::FOR, Keyword::PIZZAS, TokenType::VOTELIST},
+	[](const TokenList& tl) { // VOTE FOR PIZZAS <pizza specifier> (int), <pizza specifier> (int), ...
+		return std::unique_ptr<Statement>(new VotePizzas(std::get<VoteList>(tl[3].value)));
+	});
 
 	return g;
 }
@@ -0,0 +1,18 @@
+#include "ingredients.hpp"
+
+void IngredientTotals::add(const Pizza& p, std::int64_t weight)
+{
+	pizzas += weight;
+	crusts[static_cast<int>(p.crust)] += weight;
+	sauces[static_cast<int>(p.sauce)] += weight;
+	cheeses[static_cast<int>(p.cheese)] += weight;
+
+	const ToppingMask& tm = p.toppings.mask();
+	for (std::size_t w = 0; w < tm.size(); ++w) {
+		for (std::uint64_t bits = tm[w]; bits; bits &= bits - 1) {
+			std::size_t b = w * 64 + lowestBit(bits);
+			bool whole = (b % positionCount == static_cast<std::size_t>(ToppingPosition::ALL) - 1);
+			topping_halves[b / positionCount] += whole ? 2 * weight : weight;
+		}
+	}
+}
@@ -12,6 +12,8 @@
 #include "session.hpp"
 
 #include "parser.hpp"
+#include "transpiler.hpp"
+#include "pizzaliteral.hpp"
 #include "printer.hpp"
 #include "program.hpp"
 #include "statement.hpp"
@@ -28,6 +30,8 @@ int main(int argc, char** argv)
 	#ifdef TESTING
 
 	// This is where you can do tests and stuff 
+	constexpr Pizza lit = "[{Pesto}, {Left: Ham}]"_pizza; // (a constexpr pizza literal like this one is checked at compile time)
+	printer::showPizza(lit);
 
 	#else
 
@@ -59,6 +63,13 @@ int main(int argc, char** argv)
 				printer::PROMPT = ">> ";
 			} else if (*it == "-norepl") {
 				progstate.norepl = true;
+			} else if (*it == "-atomic") {
+				progstate.atomic = true;
+			} else if (*it == "-emit-cpp") {
+				progstate.emitcpp = true;
+				progstate.norepl = true;
+			} else if (it->rfind("-replica=", 0) == 0 && it->size() > 9) {
+				progstate.replica = Symbol::of(it->substr(9));
 			} else {
 				std::cout << "Fatal error: Unrecognized command line argument \"" << *it << "\"\n";
 				goto fatal_err;
@@ -78,6 +89,20 @@ int main(int argc, char** argv)
 				continue;
 			}
 
+			if (progstate.emitcpp) { // write out the program as C++ instead of running it
+				std::string cppfile = it->substr(0, it->rfind(".spl")) + ".cpp";
+				std::ofstream cppstream(cppfile);
+				if (!cppstream) { // (the script is skipped, as it would be if it didn't parse)
+					std::cout << "File \"" << cppfile << "\" could not be opened for writing.\n";
+					progstate.clearData();
+					continue;
+				}
+				transpiler::emitProgram(progstate.bytecode, cppstream, *it);
+				std::cout << "Emitted \"" << *it << "\" as \"" << cppfile << "\"\n";
+				progstate.clearData();
+				continue;
+			}
+
 			int retcode = execute(progstate.bytecode, progstate);
 			if (retcode) {
 				printer::reportError();
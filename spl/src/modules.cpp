@@ -0,0 +1,32 @@
+#include "modules.hpp"
+#include "parser.hpp"
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+std::string modules::canonicalPath(const std::string& path)
+{
+	std::error_code ec;
+	auto canonical = std::filesystem::canonical(path, ec);
+	if (ec || !std::filesystem::is_regular_file(canonical, ec)) return "";
+	return canonical.string();
+}
+
+std::shared_ptr<Program> modules::load(const std::string& path)
+{
+	std::error_code ec;
+	auto mtime = std::filesystem::last_write_time(path, ec);
+
+	auto cached = cache.find(path);
+	if (cached != cache.end() && cached->second.mtime == mtime) { // already parsed, and unchanged since
+		return cached->second.program;
+	}
+
+	std::ifstream source_stream(path);
+	std::ostringstream source_buffer;
+	source_buffer << source_stream.rdbuf();
+
+	auto program = std::make_shared<Program>(parser::interpret(source_buffer.str()));
+	cache[path] = Module{mtime, program}; // only cached once it has parsed successfully
+	return program;
+}
@@ -100,6 +100,7 @@ RawText parser::preprocess(RawText& raw)
 	RawText rtext = raw; 
 	
 	char parenCloser = '\0'; // this avoids recognition of #s when they are inside a pair of parentheses
+	char lastSeen = '\0'; // the last non-whitespace character, since a brace after a ')' opens a block rather than a paren
 	bool inComment = false;
 
 	Scanner pp_scan(rtext);
@@ -121,12 +122,14 @@ RawText parser::preprocess(RawText& raw)
 				pp_scan.stamp(comment_begin);
 				inComment = true;
 				continue;
-			} else if (containsKey(parenPairs, *pp_scan) && !parenCloser) { // if a paren has begun, flag it
+			} else if (containsKey(parenPairs, *pp_scan) && !parenCloser && !(*pp_scan == '{' && lastSeen == ')')) { // if a paren has begun, flag it
+				// (a block's braces are not parens, since a block contains whole statements, comments included)
 				parenCloser = parenPairs.at(*pp_scan);
 			} else if (containsValue(parenPairs, *pp_scan) && parenCloser == *pp_scan) { // if a paren has ended, lower the flag
 				parenCloser = '\0';
 			}
 
+			if (!isSpace(*pp_scan)) lastSeen = *pp_scan;
 			++pp_scan;
 		}
 	}
@@ -150,6 +153,7 @@ TokenSkeleton parser::tokenize(RawText& raw)
 	auto token_end = token_begin;
 	TokenData token_dt;
 	TokenType token_tp;
+	int blockDepth = 0;
 
 	auto start_token = [&](Scanner& sc, TokenType tt) 
 	{ 
@@ -175,18 +179,44 @@ TokenSkeleton parser::tokenize(RawText& raw)
 			scan.advanceUntil(whitespaceOrSemicolon);
 			terminate_token(scan);
 
+		} else if (*scan == '{' && !tstream.empty() && tstream.back().type == TokenType::INT) { // a brace right after an int opens a block
+
+			start_token(scan, TokenType::BLOCKBEGIN);
+			scan.advance();
+			terminate_token(scan);
+			++blockDepth;
+
+		} else if (*scan == '}' && blockDepth > 0) { // any other brace has already been consumed as part of a pizza element
+
+			start_token(scan, TokenType::BLOCKEND);
+			scan.advance();
+			terminate_token(scan);
+			--blockDepth;
+
 		} else if (containsKey(parenPairs, *scan)) { // get int/string/pizza with skip_to_char (closeParen)
 
 			start_token(scan, parenTypes.at(*scan));
 			scan.advanceUntil(matches_char(parenPairs.at(*scan))), scan.advance();
 			terminate_token(scan);
 
+		} else if (isComparison(*scan)) { // get comparator with skip_while (isComparison)
+
+			start_token(scan, TokenType::COMPARATOR);
+			scan.advanceWhile(isComparison);
+			terminate_token(scan);
+
 		} else if (*scan == ';') { // get delimiter by setting token_end to token_begin + 1
 
 			start_token(scan, TokenType::DELIMITER);
 			scan.advance();
 			terminate_token(scan);
 
+		} else if (*scan == ',') { // likewise for a comma (any comma in a pizza has already been consumed along with it)
+
+			start_token(scan, TokenType::COMMA);
+			scan.advance();
+			terminate_token(scan);
+
 		} else { // get malformed token with skip_to_whitespace_or_semicolon, then throw bad tokenize: "unrecognized token"
 
 			start_token(scan, TokenType::UNRECOGNIZED);
@@ -324,6 +354,30 @@ Token parser::lexToken(TokenPrototype& tokprot)
 			tkn.value = Delimiter{ };
 			break;
 
+		case TokenType::BLOCKBEGIN:
+			tkn.value = BlockBegin{ };
+			break;
+
+		case TokenType::BLOCKEND:
+			tkn.value = BlockEnd{ };
+			break;
+
+		case TokenType::COMMA:
+			tkn.value = Comma{ };
+			break;
+
+		case TokenType::COMPARATOR:
+			tkn.value = translate(token_content, compTrans);
+			if (std::get<Comparator>(tkn.value) == Comparator::BADPARSE) {
+				throw FAIL (
+					INVALID_COMPARATOR,
+					tokprot.data.loc,
+					tkn.data.str,
+					std::string("Invalid comparison \"" + token_content + "\"")
+				);
+			}
+			break;
+
 		default:
 			break;
 	}
@@ -369,43 +423,251 @@ std::unique_ptr<Statement> parser::parseStatement(TokenList& toks)
 }
 
 Program parser::parse(TokenList& toklst)
+{
+	auto tok = toklst.begin();
+	return parseBlock(tok, toklst.end(), nullptr);
+}
+
+Program parser::parseBlock(TokenList::iterator& tok, TokenList::iterator end, const Token* opener)
 {
 	using FAIL = BadParse;
 
 	Program prog;
-	TokenListList statements;
+	TokenList statement;
+
+	auto missing_delimiter = [&](const std::string& where) {
+		return FAIL(
+			MISSING_DELIMITER,
+			statement.front().data.loc,
+			statement.front().data.str,
+			"Expected a statement delimiter (;) before " + where
+		);
+	};
 
-	auto stmt_begin = toklst.begin();
-	auto stmt_end = toklst.begin();
+	while (tok != end) {
+		Token& t = *tok++;
+		switch (t.type) {
+
+			case TokenType::DELIMITER: // note that the delimiter is not actually part of the statement
+				if (!statement.empty()) {
+					prog.push_back(parseStatement(statement));
+					statement.clear();
+				}
+				break;
+
+			case TokenType::BLOCKBEGIN: { // the body is folded into a single token, which ends the statement it belongs to
+				Block body = std::make_shared<Program>(parseBlock(tok, end, &t));
+				statement.push_back(Token{TokenType::BLOCK, body, t.data});
+				prog.push_back(parseStatement(statement));
+				statement.clear();
+				break;
+			}
 
-	while (stmt_begin != toklst.end()) {
-	    stmt_end = std::find_if(stmt_begin, toklst.end(), [](Token t) { return t.type == TokenType::DELIMITER; });
+			case TokenType::BLOCKEND:
+				if (!statement.empty()) throw missing_delimiter("the end of the block");
+				return prog;
 
-	    if (stmt_end == toklst.end()) {
-	    	throw FAIL(
-	    		MISSING_DELIMITER,
-	    		stmt_begin->data.loc,
-	    		stmt_begin->data.str,
-	    		"Expected a statement delimiter (;) before reaching EOF"
-	    	);
-	    }
+			case TokenType::KEYWORD:
+				if (std::get<Keyword>(t.value) == Keyword::WHERE) { // the clause is folded into a single token too
+					statement.push_back(Token{TokenType::FILTER, parseFilter(tok, end, t), t.data});
+					break;
+				}
+				if (!statement.empty() && statement.back().type == TokenType::KEYWORD 
+					&& std::get<Keyword>(statement.back().value) == Keyword::BALLOT) { // and so is the list on a ballot
+					statement.push_back(t);
+					statement.push_back(Token{TokenType::SPECLIST, parseSpecifiers(tok, end, t), t.data});
+					break;
+				}
+				if (std::get<Keyword>(t.value) == Keyword::PIZZAS) { // as is the list of votes after a VOTE FOR PIZZAS
+					statement.push_back(t);
+					statement.push_back(Token{TokenType::VOTELIST, parseVotes(tok, end, t), t.data});
+					break;
+				}
+				[[fallthrough]];
 
-	    statements.emplace_back(stmt_begin, stmt_end); // note that the delimiter is not actually part of the statement
-	    stmt_begin = ++stmt_end;
+			default:
+				statement.push_back(t);
+		}
 	}
 
-	for (auto& toksgmt : statements) { // we'll handle empty statements by appending a nullptr in place of a Statement*
-		if (!toksgmt.empty()) {
-			prog.push_back(std::move(parseStatement(toksgmt)));
-		}
-	} 
+	if (!statement.empty()) throw missing_delimiter("reaching EOF");
+	if (opener) {
+		throw FAIL(
+			UNCLOSED_BLOCK,
+			opener->data.loc,
+			opener->data.str,
+			"Expected a '}' to close this block before reaching EOF"
+		);
+	}
 
 	return prog;
 }
 
+SpecifierList parser::parseSpecifiers(TokenList::iterator& tok, TokenList::iterator end, const Token& before)
+{
+	using FAIL = BadParse;
+
+	SpecifierList list;
+	for (;;) {
+		if (tok == end || !patternMatchT(*tok, SignatureToken::PSPEC)) {
+			const Token& at = (tok != end) ? *tok : before;
+			throw FAIL(MALFORMED_LIST, at.data.loc, at.data.str, "Expected a pizza specifier in the list");
+		}
+		list.push_back(toktospec(*tok++));
+		if (tok == end || tok->type != TokenType::COMMA) break;
+		++tok; // (so a trailing comma is an error)
+	}
+
+	return list;
+}
+
+VoteList parser::parseVotes(TokenList::iterator& tok, TokenList::iterator end, const Token& before)
+{
+	using FAIL = BadParse;
+
+	VoteList list;
+	for (;;) {
+		if (tok == end || !patternMatchT(*tok, SignatureToken::PSPEC)) {
+			const Token& at = (tok != end) ? *tok : before;
+			throw FAIL(MALFORMED_LIST, at.data.loc, at.data.str, "Expected a pizza specifier in the list of votes");
+		}
+		PizzaSpecifier pspec = toktospec(*tok++);
+		int n = 1;
+		if (tok != end && tok->type == TokenType::INT) n = std::get<int>((tok++)->value); // (so "(1) (3)" is three votes for #1)
+		list.emplace_back(std::move(pspec), n);
+		if (tok == end || tok->type != TokenType::COMMA) break;
+		++tok;
+	}
+
+	return list;
+}
+
+Filter parser::parseFilter(TokenList::iterator& tok, TokenList::iterator end, const Token& where)
+{
+	using FAIL = BadParse;
+
+	auto expected = [&](const std::string& what) {
+		const Token& at = (tok != end) ? *tok : where;
+		return FAIL(MALFORMED_FILTER, at.data.loc, at.data.str, "Expected " + what + " in the WHERE clause");
+	};
+	auto atKeyword = [&](Keyword kw) {
+		return tok != end && tok->type == TokenType::KEYWORD && std::get<Keyword>(tok->value) == kw;
+	};
+	auto take = [&](TokenType tt, const std::string& what) -> const Token& {
+		if (tok == end || tok->type != tt) throw expected(what);
+		return *tok++;
+	};
+
+	auto just = [](const Conjunct& c) { return Filter{{c}}; };
+	auto only = [](std::uint8_t& allowed, int value, bool negated) { // restricts allowed to value, or to anything but it
+		allowed = static_cast<std::uint8_t>(negated ? ~(1 << value) : (1 << value));
+	};
+	auto votes = [](Comparator cmp, std::int64_t n) {
+		Conjunct c;
+		switch (cmp) {
+			case Comparator::LESS: c.max_votes = n - 1; break;
+			case Comparator::LESSEQUAL: c.max_votes = n; break;
+			case Comparator::EQUAL: c.min_votes = c.max_votes = n; break;
+			case Comparator::GREATEREQUAL: c.min_votes = n; break;
+			case Comparator::GREATER: c.min_votes = n + 1; break;
+			default: break;
+		}
+		return c;
+	};
+
+	std::function<Filter(Keyword, bool)> condition = [&](Keyword kw, bool negated) -> Filter { // Compiles [NOT] kw ...
+		Conjunct c;
+		switch (kw) {
+
+			case Keyword::VEGETARIAN:
+				if (negated) c.meat = true; else c.none[0] = meatMask;
+				return just(c);
+
+			case Keyword::GLUTENFREE:
+				only(c.crusts, static_cast<int>(Crust::GLUTENFREE), negated);
+				return just(c);
+
+			case Keyword::DAIRYFREE:
+				only(c.cheeses, static_cast<int>(Cheese::DAIRYFREE), negated);
+				return just(c);
+
+			case Keyword::VEGAN: // not being vegan means missing either requirement
+				if (negated) return condition(Keyword::VEGETARIAN, true) || condition(Keyword::DAIRYFREE, true);
+				return condition(Keyword::VEGETARIAN, false) && condition(Keyword::DAIRYFREE, false);
+
+			case Keyword::HAS: { // HAS {pizza element}
+				const PizzaElement& pze = std::get<PizzaElement>(take(TokenType::PIZZAELEMENT, "a pizza element after HAS").value);
+				if (std::holds_alternative<ToppingArrangement>(pze)) {
+					std::size_t bit = ToppingSet::bitOf(std::get<ToppingArrangement>(pze));
+					(negated ? c.none : c.all)[bit / 64] |= std::uint64_t{1} << (bit % 64);
+				} else if (std::holds_alternative<Crust>(pze)) {
+					only(c.crusts, static_cast<int>(std::get<Crust>(pze)), negated);
+				} else if (std::holds_alternative<Sauce>(pze)) {
+					only(c.sauces, static_cast<int>(std::get<Sauce>(pze)), negated);
+				} else {
+					only(c.cheeses, static_cast<int>(std::get<Cheese>(pze)), negated);
+				}
+				return just(c);
+			}
+
+			case Keyword::VOTES: { // VOTES <comparison> (int)
+				Comparator cmp = std::get<Comparator>(take(TokenType::COMPARATOR, "a comparison after VOTES").value);
+				std::int64_t n = std::get<int>(take(TokenType::INT, "a number of votes").value);
+				if (!negated) return just(votes(cmp, n));
+				switch (cmp) {
+					case Comparator::LESS: return just(votes(Comparator::GREATEREQUAL, n));
+					case Comparator::LESSEQUAL: return just(votes(Comparator::GREATER, n));
+					case Comparator::GREATEREQUAL: return just(votes(Comparator::LESS, n));
+					case Comparator::GREATER: return just(votes(Comparator::LESSEQUAL, n));
+					default: return just(votes(Comparator::LESS, n)) || just(votes(Comparator::GREATER, n));
+				}
+			}
+
+			case Keyword::NAME: { // NAME "string"
+				Symbol name = Symbol::of(std::get<std::string>(take(TokenType::STRING, "a name after NAME").value));
+				if (negated) c.not_names.push_back(name); else c.name = name;
+				return just(c);
+			}
+
+			default:
+				--tok; // (so the error points at the keyword)
+				throw expected("a condition");
+		}
+	};
+
+	auto next = [&]() { // Compiles the next condition, along with the NOT before it if there is one
+		bool negated = atKeyword(Keyword::NOT);
+		if (negated) ++tok;
+		Keyword kw = std::get<Keyword>(take(TokenType::KEYWORD, "a condition").value);
+		return condition(kw, negated);
+	};
+
+	auto too_big = [&](const Filter& f) {
+		if (f.conjuncts.size() > Filter::maxConjuncts) {
+			throw FAIL(MALFORMED_FILTER, where.data.loc, where.data.str, "Too many alternatives in the WHERE clause (Try splitting it up.)");
+		}
+	};
+
+	Filter clause; // AND binds more tightly than OR, so the clause is already a disjunction of conjunctions
+	Filter conjunction = next();
+	while (atKeyword(Keyword::AND) || atKeyword(Keyword::OR)) {
+		if (std::get<Keyword>((tok++)->value) == Keyword::AND) {
+			conjunction = conjunction && next();
+		} else {
+			clause = clause || conjunction;
+			conjunction = next();
+		}
+		too_big(conjunction);
+	}
+	clause = clause || conjunction;
+	too_big(clause);
+
+	return clause;
+}
+
 Program parser::interpret(RawText raw)
 {
-	if (raw.back() != '\n') raw += '\n'; // append a newline character, just like C++ does
+	if (raw.empty() || raw.back() != '\n') raw += '\n'; // append a newline character, just like C++ does
 
 	if (meetsPredicate(raw, isSpace)) return Program { }; // File is empty, produce empty program
 
@@ -561,11 +823,9 @@ Pizza parser::parsePizza(PizzaElementList& elements)
 
 	for (PizzaElement& pze : elements) {
 		if (std::holds_alternative<ToppingArrangement>(pze)) {
-			if (containsItem(canvas.toppings, std::get<ToppingArrangement>(pze))) {
+			if (!canvas.toppings.insert(std::get<ToppingArrangement>(pze))) {
 				throw std::string("Duplicate topping"); 
-			} else {
-				canvas.toppings.push_back(std::get<ToppingArrangement>(pze));
-			} 
+			}
 		} else if (std::holds_alternative<Cheese>(pze)) {
 			if (canvas.cheese == Cheese::UNSPECIFIED) {
 				canvas.cheese = std::get<Cheese>(pze); 
@@ -604,3 +864,15 @@ Pizza parser::interpretPizza(RawText raw)
 
 	return phase_3;
 }
+
+ToppingOrder parser::writtenToppings(RawText raw)
+{
+	auto elemtexts = tokenizePizza(raw);
+	auto elements = parseElements(elemtexts);
+
+	ToppingOrder written;
+	for (PizzaElement& pze : elements) {
+		if (std::holds_alternative<ToppingArrangement>(pze)) written.push_back(std::get<ToppingArrangement>(pze));
+	}
+	return written;
+}
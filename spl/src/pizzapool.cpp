@@ -0,0 +1,53 @@
+#include "pizzapool.hpp"
+#include <algorithm>
+
+PizzaRef PizzaPool::intern(const Pizza& p)
+{
+	std::uint64_t fp = fingerprint(p);
+	auto [first, last] = by_fingerprint.equal_range(fp);
+	for (auto candidate = first; candidate != last; ++candidate) {
+		if (entries[candidate->second] == p) {
+			++uses[candidate->second];
+			return candidate->second;
+		}
+	}
+
+	PizzaRef ref;
+	if (!vacant.empty()) {
+		ref = vacant.back();
+		vacant.pop_back();
+		entries[ref] = p;
+		uses[ref] = 1;
+	} else {
+		ref = static_cast<PizzaRef>(entries.size());
+		entries.push_back(p);
+		uses.push_back(1);
+	}
+	by_fingerprint.emplace(fp, ref);
+	return ref;
+}
+
+void PizzaPool::retain(PizzaRef ref) { ++uses[ref]; }
+
+void PizzaPool::release(PizzaRef ref)
+{
+	if (--uses[ref]) return;
+
+	auto [first, last] = by_fingerprint.equal_range(fingerprint(entries[ref]));
+	by_fingerprint.erase(std::find_if(first, last, [ref](const auto& fr) { return fr.second == ref; }));
+	vacant.push_back(ref);
+}
+
+PizzaRef PizzaPool::find(const Pizza& p) const
+{
+	auto [first, last] = by_fingerprint.equal_range(fingerprint(p));
+	for (auto candidate = first; candidate != last; ++candidate) {
+		if (entries[candidate->second] == p) return candidate->second;
+	}
+	return none;
+}
+
+const Pizza& PizzaPool::operator[](PizzaRef ref) const { return entries[ref]; }
+std::size_t PizzaPool::size() const { return entries.size() - vacant.size(); }
+PizzaRef PizzaPool::capacity() const { return static_cast<PizzaRef>(entries.size()); }
+bool PizzaPool::occupied(PizzaRef ref) const { return uses[ref] != 0; }
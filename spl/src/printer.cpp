@@ -3,11 +3,16 @@
 #include <vector>
 
 void printer::showPizza(Pizza p)
+{
+	showPizza(p, ToppingOrder(p.toppings.begin(), p.toppings.end()));
+}
+
+void printer::showPizza(const Pizza& p, const ToppingOrder& written)
 {
 	std::vector<std::string> words;
 	bool base_details = p.toppings.empty() || BDETAIL_FLAG;
 
-	for (auto t : p.toppings) {
+	for (auto t : written) {
 		words.push_back(detranslate(t.topping, topDetrans) + detranslate(t.position, posDetrans)); 
 	}
 
@@ -47,7 +52,11 @@ void printer::showOrder(const PizzaOrder& po, unsigned int ordinal)
 		}
 	}
 	
-	showPizza(po.pizza);
+	if (po.written.empty()) {
+		showPizza(po.pizza);
+	} else {
+		showPizza(po.pizza, po.written);
+	}
 	std::cout << " " << "[" << po.votes << " votes]" << '\n';
 
 }
@@ -66,25 +75,122 @@ void printer::showSessionInfo(const OrderSession& os, bool pizza_deets)
 	if (!os.session_name.empty()) {
 		std::cout << os.session_name << ": ";
 	}
-	std::cout << os.orders.size() << " pizzas ordered.\n\n";
-	for (unsigned int i = 0; i < os.orders.size(); ++i) {
+	std::cout << os.size() << " pizzas ordered.\n\n";
+	for (std::size_t slot = 0; slot < os.slots(); ++slot) {
+		if (!os.live[slot]) continue;
 		if (pizza_deets) {
-			showOrderWithInfo(os.orders.at(i), i + 1);
+			showOrderWithInfo(os.order(slot), os.ids[slot]);
 		} else {
-			showOrder(os.orders.at(i), i + 1);
+			showOrder(os.order(slot), os.ids[slot]);
 		}
 		std::cout << '\n';
 	}
 }
 
+void printer::showMatchingOrders(const OrderSession& os, const SlotSet& slots, bool pizza_deets)
+{
+	std::cout << slots.size() << (slots.size() == 1 ? " pizza matches.\n\n" : " pizzas match.\n\n");
+	slots.forEach([&](std::size_t slot) {
+		if (pizza_deets) {
+			showOrderWithInfo(os.order(slot), os.ids[slot]);
+		} else {
+			showOrder(os.order(slot), os.ids[slot]);
+		}
+		std::cout << '\n';
+	});
+}
+
 void printer::showTopOrders(const OrderSession& os, int n)
 {
 	std::cout << "Top " << n << " orders:\n";
-	auto scoreboard = os.orders;
-	auto nn = static_cast<unsigned int>(n);
-	std::sort(scoreboard.begin(), scoreboard.end(), operator>);
-	for (unsigned int i = 0; i < scoreboard.size() && i < nn; ++i) {
-		showOrder(scoreboard.at(i), 0);
+	for (std::size_t slot : os.topSlots(n)) {
+		showOrder(os.order(slot), 0);
+	}
+}
+
+void printer::showTopOrders(const OrderSession& os, int n, const SlotSet& among)
+{
+	std::cout << "Top " << n << " orders:\n";
+	for (std::size_t slot : os.topSlots(n, &among)) {
+		showOrder(os.order(slot), 0);
+	}
+}
+
+void printer::showApproximateTop(const OrderSession& os, int n)
+{
+	const VoteSketch& vs = *os.sketch;
+	std::cout << "Top " << n << " orders, approximately (" << vs.top.total() << " votes";
+	if (std::uint64_t v = vs.voters.estimate()) std::cout << " from about " << v << " voters";
+	std::cout << " for about " << vs.pizzas.estimate() << " distinct pizzas):\n";
+	for (const SpaceSaving::Counter& c : vs.top.top(n)) {
+		std::size_t slot = os.locate(c.pizza); // (a pizza that was ordered gets its order's name, if it has one)
+		if (slot != OrderSession::npos && !os.names[slot].empty()) {
+			std::cout << "\"" << os.names[slot] << "\"" << ": ";
+		}
+		if (slot != OrderSession::npos) {
+			showPizza(c.pizza, os.written(slot));
+		} else {
+			showPizza(c.pizza);
+		}
+		std::cout << " [";
+		if (c.error) std::cout << c.count - c.error << " to ";
+		std::cout << c.count << " votes]\n";
+	}
+	if (vs.top.floor()) {
+		std::cout << "(Any other pizza has at most " << vs.top.floor() << " votes.)\n";
+	}
+}
+
+void printer::showStandings(const OrderSession& os, int n, Tally how)
+{
+	static const char* const methods[] = {"instant runoff", "Borda count", "approval"}; // (indexed by Tally)
+	static const char* const units[] = {"votes", "points", "approvals"};
+	const BallotBox& box = (how == Tally::APPROVAL) ? os.approval_ballots : os.ranked_ballots;
+
+	std::cout << "Top " << n << " orders by " << methods[static_cast<int>(how)] << " (from " << box.size() << " ballots):\n";
+	for (auto [slot, score] : os.standings(how, n)) {
+		if (!os.names[slot].empty()) {
+			std::cout << "\"" << os.names[slot] << "\"" << ": ";
+		}
+		showPizza(os.pizza(slot), os.written(slot));
+		std::cout << " [" << score << " " << units[static_cast<int>(how)] << "]\n";
+	}
+}
+
+void printer::showNearestOrders(const OrderSession& os, const Pizza& p, int n, bool pizza_deets)
+{
+	std::cout << "Nearest " << n << " orders:\n";
+	for (auto [slot, sim] : os.nearest(p, n)) {
+		std::cout << "(" << sim.percent() << "%) ";
+		if (pizza_deets) {
+			showOrderWithInfo(os.order(slot), os.ids[slot]);
+			std::cout << '\n';
+		} else {
+			showOrder(os.order(slot), os.ids[slot]);
+		}
+	}
+}
+
+void printer::showIngredients(const IngredientTotals& totals, bool by_votes)
+{
+	std::cout << "Ingredients for " << totals.pizzas << (totals.pizzas == 1 ? " pizza" : " pizzas")
+		<< (by_votes ? " (one per vote):\n" : ":\n");
+
+	auto show = [](const std::string& what, std::int64_t amount) {
+		if (amount) std::cout << what << ": " << amount << '\n';
+	};
+	for (std::size_t c = 1; c < totals.crusts.size(); ++c) {
+		show(detranslate(static_cast<Crust>(c), crustDetrans), totals.crusts[c]);
+	}
+	for (std::size_t s = 1; s < totals.sauces.size(); ++s) {
+		if (static_cast<Sauce>(s) != Sauce::NONE) show(detranslate(static_cast<Sauce>(s), sauceDetrans), totals.sauces[s]);
+	}
+	for (std::size_t ch = 1; ch < totals.cheeses.size(); ++ch) {
+		if (static_cast<Cheese>(ch) != Cheese::NONE) show(detranslate(static_cast<Cheese>(ch), cheeseDetrans), totals.cheeses[ch]);
+	}
+	for (int d = 0; d < toppingCount; ++d) { // (halves, so an odd count ends in a half)
+		std::int64_t halves = totals.topping_halves[d];
+		if (halves) std::cout << detranslate(sparseTopping(d), topDetrans) << ": " << halves / 2 << (halves % 2 ? ".5" : "") << '\n';
 	}
 }
 
@@ -98,6 +204,11 @@ void printer::reportError()
 	std::cout << "Error encountered, execution halted." << '\n';
 }
 
+void printer::reportRollback()
+{
+	std::cout << "Transaction rolled back." << '\n';
+}
+
 void printer::reportRuntimeError(const std::string& txt, ProgramState& ps)
 {
 	std::cout << "Statement #" << ps.programcounter << ": " << txt << '\n';
@@ -1,79 +1,604 @@
 #include "session.hpp"
 #include <algorithm>
+#include <unordered_set>
 
 OrderSession::OrderSession() 
 { ; }
 
 OrderSession::OrderSession(int n) 
 { 
-	orders.reserve(n);
+	votes.reserve(n);
+	vote_epochs.reserve(n);
+	pizza_refs.reserve(n);
+	ids.reserve(n);
+	live.reserve(n);
+	names.reserve(n);
+	vote_counts.reserve(n);
+	arrangements.reserve(n);
 }
 
-OrderSession::OrderSession(const std::string& n) : session_name{n}
+OrderSession::OrderSession(Symbol n) : session_name{n}
 { ; }
 
-OrderSession::OrderSession(const std::string& nm, int nmb) : session_name{nm}
+OrderSession::OrderSession(Symbol nm, int nmb) : OrderSession(nmb)
 {
-	orders.reserve(nmb);
+	session_name = nm;
 }
 
-void OrderSession::add(const PizzaOrder& po) { orders.push_back(po); }
-void OrderSession::rename(const std::string& n) { session_name = n; }
+std::size_t OrderSession::size() const { return live_count; }
+std::size_t OrderSession::slots() const { return votes.size(); }
 
-std::vector<PizzaOrder>::iterator OrderSession::locateIt(int pizza_number)
+PizzaOrder OrderSession::order(std::size_t slot) const
 {
-	if (pizza_number > (int)orders.size() || pizza_number <= 0) {
-		return orders.end(); // out of bounds 
+	PizzaOrder po(pizza(slot), names[slot]);
+	po.votes = tally(slot);
+	po.written = written(slot);
+	return po;
+}
+
+const Pizza& OrderSession::pizza(std::size_t slot) const { return pool[pizza_refs[slot]]; }
+
+ToppingOrder OrderSession::written(std::size_t slot) const
+{
+	ToppingOrder to;
+	for (const std::uint8_t* b = arrangements.begin(slot); b != arrangements.end(slot); ++b) {
+		to.push_back(ToppingSet::arrangementOf(*b));
+	}
+	return to;
+}
+
+OrderSession OrderSession::fresh() const
+{
+	OrderSession os(session_name);
+	os.replica = replica;
+	os.next_id = next_id;
+	os.first_id = next_id; // (so it starts out mapping nothing, however many IDs this session has given out)
+	if (sketch) os.sketch.emplace(sketch->top.capacity());
+	return os;
+}
+
+static std::int64_t total(const ReplicaCount* first, const ReplicaCount* last)
+{
+	std::int64_t sum = 0;
+	for (; first != last; ++first) sum += first->up - first->down;
+	return sum;
+}
+
+static std::int64_t total(const VoteCounts& counts) { return total(counts.data(), counts.data() + counts.size()); }
+
+static void countIn(VoteCounts& counts, Symbol replica, std::int64_t change) // Adds change to replica's counter
+{
+	if (!change) return;
+	auto rc = std::find_if(counts.begin(), counts.end(), [replica](const ReplicaCount& c) { return c.replica == replica; });
+	if (rc == counts.end()) rc = counts.insert(counts.end(), ReplicaCount{replica});
+	if (change > 0) {
+		rc->up += change;
 	} else {
-		return orders.begin() + pizza_number - 1;
+		rc->down -= change;
+	}
+}
+
+static std::vector<std::uint8_t> bitsOf(const ToppingOrder& written)
+{
+	std::vector<std::uint8_t> bits;
+	for (ToppingArrangement ta : written) bits.push_back(static_cast<std::uint8_t>(ToppingSet::bitOf(ta)));
+	return bits;
+}
+
+int OrderSession::add(const Pizza& p, Symbol name, const ToppingOrder& written) { return add(p, name, written, VoteCounts{}); }
+
+int OrderSession::add(const Pizza& p, Symbol name, const ToppingOrder& written, const VoteCounts& counts)
+{ 
+	std::vector<std::uint8_t> bits = bitsOf(written);
+	votes.push_back(static_cast<int>(total(counts)));
+	vote_epochs.push_back(epoch);
+	pizza_refs.push_back(pool.intern(p));
+	ids.push_back(next_id);
+	live.push_back(true);
+	names.push_back(name);
+	vote_counts.push_back(counts.begin(), counts.end());
+	arrangements.push_back(bits.begin(), bits.end());
+	rearrange(slots() - 1);
+
+	slot_of.push_back(slots() - 1);
+	++live_count;
+	index(slots() - 1);
+	return next_id++;
+}
+
+void OrderSession::remove(std::size_t slot)
+{
+	unindex(slot);
+	pool.release(pizza_refs[slot]);
+	pizza_refs[slot] = PizzaPool::none;
+	live[slot] = false;
+	slotOf(ids[slot]) = npos;
+	--live_count;
+
+	std::size_t tombstones = slots() - live_count;
+	if (tombstones > live_count && tombstones >= 32) compact(); // each compaction is paid for by the removals since the last
+}
+
+void OrderSession::remove(const SlotSet& doomed)
+{
+	if (doomed.empty()) return;
+	std::unordered_set<Symbol> doomed_names;
+	doomed.forEach([&](std::size_t slot) { // (taking each one out of the indices would cost more than rebuilding them)
+		if (!names[slot].empty()) doomed_names.insert(names[slot]);
+		pool.release(pizza_refs[slot]);
+		pizza_refs[slot] = PizzaPool::none;
+		live[slot] = false;
+		slotOf(ids[slot]) = npos;
+		--live_count;
+	});
+
+	std::size_t tombstones = slots() - live_count;
+	if (tombstones > live_count && tombstones >= 32) {
+		compact();
+	} else {
+		reindex();
+	}
+	for (Symbol name : doomed_names) {
+		if (name_index.find(name) == name_index.end()) name_suffixes.erase(name); // no order has it any more
+	}
+}
+
+void OrderSession::removeLast()
+{
+	unindex(slots() - 1);
+	pool.release(pizza_refs.back());
+	next_id = ids.back();
+	slot_of.pop_back();
+	--live_count;
+
+	votes.pop_back();
+	vote_epochs.pop_back();
+	pizza_refs.pop_back();
+	ids.pop_back();
+	live.pop_back();
+	names.pop_back();
+	vote_counts.pop_back();
+	arrangements.pop_back();
+}
+
+void OrderSession::reinstate(int id, const PizzaOrder& po, const VoteCounts& counts)
+{
+	std::size_t slot = std::lower_bound(ids.begin(), ids.end(), id) - ids.begin();
+	std::vector<std::uint8_t> bits = bitsOf(po.written);
+	++live_count;
+
+	if (slot < slots() && ids[slot] == id) { // its tombstone hasn't been compacted away, so it can go straight back
+		votes[slot] = po.votes;
+		vote_epochs[slot] = epoch;
+		pizza_refs[slot] = pool.intern(po.pizza);
+		live[slot] = true;
+		names[slot] = po.name;
+		vote_counts.assign(slot, counts.begin(), counts.end());
+		arrangements.assign(slot, bits.begin(), bits.end());
+		rearrange(slot);
+		slotOf(id) = slot;
+		index(slot);
+	} else {
+		votes.insert(votes.begin() + slot, po.votes);
+		vote_epochs.insert(vote_epochs.begin() + slot, epoch);
+		pizza_refs.insert(pizza_refs.begin() + slot, pool.intern(po.pizza));
+		ids.insert(ids.begin() + slot, id);
+		live.insert(live.begin() + slot, true);
+		names.insert(names.begin() + slot, po.name);
+		vote_counts.insert(slot, counts.begin(), counts.end());
+		arrangements.insert(slot, bits.begin(), bits.end());
+		rearrange(slot);
+		if (!po.name.empty() && name_index.find(po.name) == name_index.end()) name_suffixes.insert(po.name);
+		reindex(); // every slot after this one has moved
+	}
+}
+
+void OrderSession::rename(Symbol n) { session_name = n; }
+
+void OrderSession::renameOrder(std::size_t slot, Symbol n)
+{
+	if (!names[slot].empty()) { // only the name index needs to hear about it
+		auto [first, last] = name_index.equal_range(names[slot]);
+		name_index.erase(std::find_if(first, last, [slot](const auto& ns) { return ns.second == slot; }));
+		if (name_index.find(names[slot]) == name_index.end()) name_suffixes.erase(names[slot]);
+	}
+	names[slot] = n;
+	if (!n.empty()) {
+		if (name_index.find(n) == name_index.end()) name_suffixes.insert(n);
+		name_index.emplace(n, slot);
+	}
+}
+
+void OrderSession::setPizza(std::size_t slot, const Pizza& p, const ToppingOrder& written)
+{
+	std::vector<std::uint8_t> bits = bitsOf(written);
+	arrangements.assign(slot, bits.begin(), bits.end());
+	setPizza(slot, p);
+}
+
+void OrderSession::setPizza(std::size_t slot, const Pizza& p)
+{
+	unindex(slot);
+	PizzaRef altered = pool.intern(p); // (interned before the original is released, in case they're the same)
+	pool.release(pizza_refs[slot]);
+	pizza_refs[slot] = altered;
+	rearrange(slot);
+	index(slot);
+}
+
+void OrderSession::setPizzas(const SlotSet& chosen, const std::function<bool(Pizza&)>& alter)
+{
+	std::unordered_map<PizzaRef, PizzaRef> becomes; // what each pizza seen so far was altered into
+	bool altered = false;
+
+	chosen.forEach([&](std::size_t slot) {
+		PizzaRef old = pizza_refs[slot];
+		auto [seen, first] = becomes.try_emplace(old, old);
+		if (first) {
+			Pizza pz = pool[old];
+			if (alter(pz)) seen->second = pool.intern(pz); // (which counts this order's use of it)
+		} else if (seen->second != old) {
+			pool.retain(seen->second);
+		}
+		if (seen->second == old) return;
+
+		pool.release(old); // (a freed entry can't be one that's still to come, since nothing else uses it)
+		pizza_refs[slot] = seen->second;
+		rearrange(slot);
+		altered = true;
+	});
+
+	if (altered) reindex();
+}
+
+void OrderSession::rearrange(std::size_t slot)
+{
+	std::uint8_t bits[ToppingSet::capacity]; // the toppings still in its arrangement, in the order they're in, and then the rest
+	std::size_t n = 0;
+	ToppingSet left = pizza(slot).toppings;
+	for (const std::uint8_t* b = arrangements.begin(slot); b != arrangements.end(slot); ++b) {
+		if (left.erase(ToppingSet::arrangementOf(*b))) bits[n++] = *b;
+	}
+	for (ToppingArrangement ta : left) bits[n++] = static_cast<std::uint8_t>(ToppingSet::bitOf(ta));
+	arrangements.assign(slot, bits, bits + n);
+}
+
+void OrderSession::index(std::size_t slot)
+{
+	if (!names[slot].empty()) {
+		if (name_index.find(names[slot]) == name_index.end()) name_suffixes.insert(names[slot]); // the first order with its name
+		name_index.emplace(names[slot], slot);
+	}
+	PizzaRef ref = pizza_refs[slot];
+	if (ref >= pizza_index.size()) { // the pool has grown since
+		pizza_index.resize(pool.capacity());
+		first_with.resize(pool.capacity(), npos);
+	}
+	pizza_index[ref].insert(slot);
+	first_with[ref] = std::min(first_with[ref], slot);
+	for (ToppingArrangement ta : pizza(slot).toppings) topping_index[ToppingSet::bitOf(ta)].insert(slot);
+	if (tally(slot)) leaderboard.emplace(vote_epochs[slot], votes[slot], slot);
+}
+
+void OrderSession::unindex(std::size_t slot)
+{
+	if (!names[slot].empty()) {
+		auto [first, last] = name_index.equal_range(names[slot]);
+		auto entry = std::find_if(first, last, [slot](const auto& ns) { return ns.second == slot; });
+		if (entry != last) name_index.erase(entry);
+		if (name_index.find(names[slot]) == name_index.end()) name_suffixes.erase(names[slot]); // the last order with its name
+	}
+	PizzaRef ref = pizza_refs[slot];
+	pizza_index[ref].erase(slot);
+	if (first_with[ref] == slot) first_with[ref] = pizza_index[ref].empty() ? npos : pizza_index[ref].first();
+	for (ToppingArrangement ta : pizza(slot).toppings) topping_index[ToppingSet::bitOf(ta)].erase(slot);
+	leaderboard.erase({vote_epochs[slot], votes[slot], slot}); // (it may have been swept away already)
+}
+
+void OrderSession::compact()
+{
+	std::size_t to = 0;
+	for (std::size_t from = 0; from < slots(); ++from) {
+		if (!live[from]) continue;
+		if (to != from) {
+			votes[to] = votes[from];
+			vote_epochs[to] = vote_epochs[from];
+			pizza_refs[to] = pizza_refs[from];
+			ids[to] = ids[from];
+			names[to] = names[from];
+		}
+		++to;
+	}
+
+	votes.resize(to);
+	vote_epochs.resize(to);
+	pizza_refs.resize(to);
+	ids.resize(to);
+	names.resize(to);
+	vote_counts.keep(live);
+	arrangements.keep(live);
+	live.assign(to, true);
+	reindex();
+}
+
+void OrderSession::reindex()
+{
+	name_index.clear(); // (the suffix index holds names rather than slots, so it doesn't care where orders have moved to)
+	for (SlotSet& ss : pizza_index) ss.clear();
+	pizza_index.resize(pool.capacity());
+	first_with.assign(pool.capacity(), npos);
+	for (SlotSet& ss : topping_index) ss.clear();
+
+	std::vector<Ranking> ranked;
+	for (std::size_t i = 0; i < slots(); ++i) {
+		if (!live[i]) continue;
+		slotOf(ids[i]) = i;
+		if (!names[i].empty()) name_index.emplace(names[i], i);
+		pizza_index[pizza_refs[i]].insert(i);
+		first_with[pizza_refs[i]] = std::min(first_with[pizza_refs[i]], i);
+		for (ToppingArrangement ta : pizza(i).toppings) topping_index[ToppingSet::bitOf(ta)].insert(i);
+		if (tally(i)) ranked.emplace_back(epoch, votes[i], i);
+	}
+	std::sort(ranked.begin(), ranked.end(), MoreVotes{});
+
+	leaderboard.clear();
+	for (const auto& vs : ranked) {
+		leaderboard.emplace_hint(leaderboard.end(), vs); // already in order, so each insertion is constant time
+	}
+}
+
+std::size_t OrderSession::locate(int pizza_id) const
+{
+	if (pizza_id >= next_id || pizza_id < first_id) {
+		return npos; // out of bounds (or from before the session was reset)
+	} else {
+		return slot_of[pizza_id - first_id];
 	}
 } 
 
-std::vector<PizzaOrder>::iterator OrderSession::locateIt(const std::string& pizza_name)
+std::size_t OrderSession::locate(Symbol pizza_name) const
+{
+	std::size_t found = npos; // the earliest order with the name wins, as it would in a linear search
+	auto [first, last] = name_index.equal_range(pizza_name);
+	for (auto candidate = first; candidate != last; ++candidate) {
+		found = std::min(found, candidate->second);
+	}
+	return found;
+}
+
+std::size_t OrderSession::locate(const Pizza& pizza_replica) const
+{
+	PizzaRef ref = pool.find(pizza_replica); // (every order of the pizza shares its reference)
+	return ref < first_with.size() ? first_with[ref] : npos; // likewise, the earliest (and none is past the end)
+}
+
+const SlotSet& OrderSession::withTopping(ToppingArrangement ta) const { return topping_index[ToppingSet::bitOf(ta)]; }
+
+SlotSet OrderSession::like(std::string_view pattern) const
+{
+	SlotSet found; // (the work is proportional to the names that match, however many orders there are)
+	for (Symbol name : name_suffixes.like(pattern)) {
+		auto [first, last] = name_index.equal_range(name);
+		for (auto ns = first; ns != last; ++ns) found.insert(ns->second);
+	}
+	return found;
+}
+
+int OrderSession::tally(std::size_t slot) const { return vote_epochs[slot] == epoch ? votes[slot] : 0; }
+
+void OrderSession::vote(std::size_t slot, int amount) 
+{ 
+	rank(slot, tally(slot) + amount); // (this replica's counter catches up when it's next settled)
+	sweep(2); // two for every one that might be added keeps the leftovers draining
+}
+
+void OrderSession::rank(std::size_t slot, int t)
 {
-	return std::find_if(
-		orders.begin(),
-		orders.end(),
-		[&pizza_name](const PizzaOrder& po) { return po.name == pizza_name; });
+	auto ranked = leaderboard.extract({vote_epochs[slot], votes[slot], slot}); // reuses the node rather than reallocating it
+	votes[slot] = t;
+	vote_epochs[slot] = epoch;
+
+	if (t && ranked) {
+		ranked.value() = {epoch, t, slot};
+		leaderboard.insert(std::move(ranked));
+	} else if (t) {
+		leaderboard.emplace(epoch, t, slot);
+	}
 }
 
-std::vector<PizzaOrder>::iterator OrderSession::locateIt(Pizza pizza_replica)
+void OrderSession::setVote(std::size_t slot, int t) { vote(slot, t - tally(slot)); }
+
+VoterTable::Entry OrderSession::voteAs(Symbol voter, std::size_t slot, int amount)
 {
-	return std::find_if(
-		orders.begin(),
-		orders.end(),
-		[&pizza_replica](const PizzaOrder& po) { return po.pizza == pizza_replica; });
+	VoterTable::Entry& current = voters[voter]; // (looked up just the once, since with millions of voters it's a cache miss)
+	VoterTable::Entry before = current;
+	recast(current, VoterTable::Entry{voter, epoch, ids[slot], amount});
+	return before;
 }
 
-unsigned int OrderSession::locateIndex(int pizza_number) { return pizza_number; }
-unsigned int OrderSession::locateIndex(const std::string& pizza_name) { return locateIt(pizza_name) - orders.begin(); }
-unsigned int OrderSession::locateIndex(Pizza pizza_replica) { return locateIt(pizza_replica) - orders.begin(); }
+void OrderSession::setVoter(const VoterTable::Entry& e) { recast(voters[e.voter], e); }
 
-bool OrderSession::located(int pizza_number) { return locateIt(pizza_number) != orders.end(); }
-bool OrderSession::located(const std::string& pizza_name) { return locateIt(pizza_name) != orders.end(); }
-bool OrderSession::located(Pizza pizza_replica) { return locateIt(pizza_replica) != orders.end(); }
+void OrderSession::recast(VoterTable::Entry& current, const VoterTable::Entry& e)
+{
+	auto slotOf = [&](const VoterTable::Entry& v) { // (a vote from before a reset has nothing left to take back,
+		return (v.epoch == epoch && v.id) ? locate(v.id) : npos; // and nor does one for an order that's since been removed)
+	};
+	std::size_t from = slotOf(current), to = slotOf(e);
+	if (from != npos && from == to) { // a change of heart about how much is a single adjustment
+		vote(from, e.amount - current.amount);
+	} else {
+		if (from != npos) vote(from, -current.amount);
+		if (to != npos) vote(to, e.amount);
+	}
+	current = e;
+}
 
-PizzaOrder& OrderSession::locate(int pizza_number) { return *locateIt(pizza_number); }
-PizzaOrder& OrderSession::locate(const std::string& pizza_name) { return *locateIt(pizza_name); }
-PizzaOrder& OrderSession::locate(Pizza pizza_replica) { return *locateIt(pizza_replica); }
+VoteCounts OrderSession::counts(std::size_t slot) const
+{
+	VoteCounts settled(vote_counts.begin(slot), vote_counts.end(slot));
+	countIn(settled, replica, tally(slot) - total(settled)); // this replica's votes since they were last settled
+	return settled;                                          // (less any that a reset has zeroed since)
+}
 
-void OrderSession::vote(int pizza_number, int amount) { locate(pizza_number).votes += amount; }
-void OrderSession::vote(const std::string& pizza_name, int amount) { locate(pizza_name).votes += amount; }
-void OrderSession::vote(Pizza pizza_replica, int amount) { locate(pizza_replica).votes += amount; }
-/*
-std::vector<PizzaOrder> OrderSession::tally(int winners)
+void OrderSession::settle(std::size_t slot)
 {
-	std::vector<PizzaOrder> winnerList(orders);
-	std::sort(winnerList.begin(), winnerList.end(), operator>);
-	winnerList.resize(winners, defaultPizza);
-	return winnerList;
+	if (tally(slot) == total(vote_counts.begin(slot), vote_counts.end(slot))) return; // (as it mostly is)
+	VoteCounts settled = counts(slot);
+	vote_counts.assign(slot, settled.begin(), settled.end());
 }
-*/
-void OrderSession::resetVotes()
+
+void OrderSession::sweep(int n)
+{
+	for (; n > 0 && !leaderboard.empty() && std::get<0>(*leaderboard.rbegin()) != epoch; --n) {
+		leaderboard.erase(std::prev(leaderboard.end()));
+	}
+}
+
+std::vector<std::size_t> OrderSession::topSlots(int n, const SlotSet* among) const
+{
+	std::vector<std::size_t> top;
+	std::size_t nn = std::min<std::size_t>(n, among ? among->size() : size());
+
+	if (among && among->size() < leaderboard.size()) { // a few slots are quicker to rank by themselves than to pick out
+		top.reserve(among->size());                     // of the leaderboard, where they may be anywhere
+		among->forEach([&](std::size_t slot) { top.push_back(slot); });
+		std::partial_sort(top.begin(), top.begin() + nn, top.end(), [&](std::size_t s1, std::size_t s2) {
+			return tally(s1) != tally(s2) ? tally(s1) > tally(s2) : s1 < s2; // (the leaderboard's order)
+		});
+		top.resize(nn);
+		return top;
+	}
+	top.reserve(nn);
+
+	auto ranked = leaderboard.begin();
+	auto current = [&]() { return ranked != leaderboard.end() && std::get<0>(*ranked) == epoch; };
+	auto counts = [&](std::size_t slot) { return !among || among->contains(slot); };
+
+	for (; current() && std::get<1>(*ranked) > 0 && top.size() < nn; ++ranked) { // positive tallies
+		if (counts(std::get<2>(*ranked))) top.push_back(std::get<2>(*ranked));
+	}
+	if (among) { // zero tallies aren't ranked, but they tie in slot order, so the slots are walked until there are enough
+		if (top.size() < nn) among->forEachWhile([&](std::size_t slot) { // (passing over no more ranked ones
+			if (!tally(slot)) top.push_back(slot);                         // than are on the leaderboard)
+			return top.size() < nn;
+		});
+	} else {
+		for (std::size_t slot = 0; slot < slots() && top.size() < nn; ++slot) {
+			if (live[slot] && !tally(slot)) top.push_back(slot);
+		}
+	}
+	for (; current() && top.size() < nn; ++ranked) { // negative tallies
+		if (counts(std::get<2>(*ranked))) top.push_back(std::get<2>(*ranked));
+	}
+	return top;
+}
+
+std::vector<std::pair<std::size_t, Similarity>> OrderSession::nearest(const Pizza& p, int n) const
+{
+	std::vector<std::pair<std::size_t, Similarity>> near;
+	if (n <= 0) return near;
+
+	std::vector<std::pair<Similarity, PizzaRef>> scored; // each distinct pizza is scored once, however many orders share it
+	scored.reserve(pool.size());
+	ToppingMask halves = halvesOf(p.toppings.mask());
+	for (PizzaRef ref = 0; ref < pool.capacity(); ++ref) {
+		if (pool.occupied(ref)) scored.emplace_back(similarity(p, halves, pool[ref]), ref);
+	}
+
+	auto more_alike = [](const auto& s1, const auto& s2) { return s1.first > s2.first; };
+	if (scored.size() > static_cast<std::size_t>(n)) { // every pooled pizza has an order, so the n most alike are enough,
+		std::nth_element(scored.begin(), scored.begin() + (n - 1), scored.end(), more_alike); // along with any that tie them
+		Similarity cutoff = scored[n - 1].first;
+		scored.erase(std::remove_if(scored.begin(), scored.end(), [cutoff](const auto& sr) { return sr.first < cutoff; }), scored.end());
+	}
+
+	for (const auto& [sim, ref] : scored) {
+		pizza_index[ref].forEach([&](std::size_t slot) { near.emplace_back(slot, sim); });
+	}
+	std::size_t nn = std::min<std::size_t>(n, near.size());
+	std::partial_sort(near.begin(), near.begin() + nn, near.end(), [](const auto& ss1, const auto& ss2) {
+		if (ss1.second != ss2.second) return ss1.second > ss2.second;
+		return ss1.first < ss2.first;
+	});
+	near.resize(nn);
+	return near;
+}
+
+IngredientTotals OrderSession::ingredients(bool by_votes, const std::vector<std::size_t>* among) const
 {
-	for (auto& order : orders) {
-		order.votes = 0;
+	std::vector<std::int64_t> weights(pool.capacity()); // one pass down the columns adds up how much of each pooled pizza there is,
+	auto weigh = [&](std::size_t slot) {               // so each distinct pizza is only taken apart once
+		weights[pizza_refs[slot]] += by_votes ? std::max(tally(slot), 0) : 1;
+	};
+	if (among) {
+		for (std::size_t slot : *among) weigh(slot);
+	} else {
+		for (std::size_t slot = 0; slot < slots(); ++slot) {
+			if (live[slot]) weigh(slot);
+		}
+	}
+
+	IngredientTotals totals;
+	for (PizzaRef ref = 0; ref < pool.capacity(); ++ref) {
+		if (weights[ref]) totals.add(pool[ref], weights[ref]);
 	}
+	return totals;
+}
+
+void OrderSession::resetVotes()
+{
+	++epoch; // the leaderboard's entries are all stale now, and sink out of the way
+}
+
+void OrderSession::reset() 
+{ 
+	*this = fresh();
 }
 
-void OrderSession::reset() { orders.clear(); }
\ No newline at end of file
+void OrderSession::merge(const OrderSession& other)
+{
+	auto key = [](PizzaRef ref, Symbol name) { return std::uint64_t{ref} << 32 | name.id; };
+
+	std::unordered_map<std::uint64_t, std::size_t> unmatched; // the first order with each key that nothing has paired up with yet
+	std::vector<std::size_t> next_alike(slots(), npos); // the next order after each one with the same key
+	for (std::size_t slot = slots(); slot-- > 0;) { // (backwards, so each list comes out in slot order)
+		if (!live[slot]) continue;
+		auto [head, first_seen] = unmatched.try_emplace(key(pizza_refs[slot], names[slot]), slot);
+		if (!first_seen) {
+			next_alike[slot] = head->second;
+			head->second = slot;
+		}
+
+		settle(slot); // (so the counters can be merged as they are)
+		if (vote_epochs[slot] != epoch) { // its old epoch's entry comes off the leaderboard before its tally is rewritten
+			rank(slot, static_cast<int>(total(vote_counts.begin(slot), vote_counts.end(slot))));
+		}
+	}
+
+	for (std::size_t from = 0; from < other.slots(); ++from) {
+		if (!other.live[from]) continue;
+		VoteCounts theirs = other.counts(from);
+
+		PizzaRef ref = pool.find(other.pizza(from));
+		auto match = (ref == PizzaPool::none) ? unmatched.end() : unmatched.find(key(ref, other.names[from]));
+		if (match == unmatched.end() || match->second == npos) {
+			add(other.pizza(from), other.names[from], other.written(from), theirs);
+			continue;
+		}
+
+		std::size_t slot = match->second;
+		match->second = next_alike[slot];
+		VoteCounts ours(vote_counts.begin(slot), vote_counts.end(slot));
+		for (const ReplicaCount& rc : theirs) {
+			auto same = std::find_if(ours.begin(), ours.end(), [&rc](const ReplicaCount& c) { return c.replica == rc.replica; });
+			if (same == ours.end()) {
+				ours.push_back(rc);
+			} else {
+				same->up = std::max(same->up, rc.up);
+				same->down = std::max(same->down, rc.down);
+			}
+		}
+		vote_counts.assign(slot, ours.begin(), ours.end());
+		rank(slot, static_cast<int>(total(ours))); // (the orders that are added are indexed and ranked as they go)
+	}
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "session.hpp"
+#include "parser.hpp"
+#include "syntax.hpp"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+// The session file format is plain text, one record per line:
+//
+//   SPL SESSION 1
+//   NAME "Prod Night"
+//   NEXT 8
+//   ORDER 3 "Cheeza" [{CRUST: STANDARD}, {SAUCE: TOMATO}, {CHEESE: TRIPLEMOZZARELLA}, {ALL: FETA}]
+//   VOTES "site-a" 5 1
+//   VOTES "site-b" 2 0
+//   BALLOT RANKED 3 1
+//   BALLOT APPROVAL 1
+//   VOTER "Ada" 3 2
+//   END
+//
+// Each ORDER is followed by its counters, one VOTES line (replica, up, down) for each replica that has voted on it
+// The ballots come after the orders, each as the IDs on it (some of which may belong to orders that have since been removed)
+// Then comes each voter's current vote (voter, ID, amount), which the counters already include
+// Strings are quoted as by std::quoted, and pizzas are written out in full, in the same syntax scripts use
+
+template<typename T, std::size_t N>
+static std::string_view nameOf(T value, const Name<T> (&names)[N]) // The first name is the canonical one
+{
+	for (const Name<T>& n : names) {
+		if (n.value == value) return n.text;
+	}
+	return "";
+}
+
+static std::string pizzaText(const Pizza& p, const ToppingOrder& written) // (the toppings are saved in the order they were written)
+{
+	std::string text = "[{CRUST: " + std::string(nameOf(p.crust, crustNames)) + "}, "
+		+ "{SAUCE: " + std::string(nameOf(p.sauce, sauceNames)) + "}, "
+		+ "{CHEESE: " + std::string(nameOf(p.cheese, cheeseNames)) + "}";
+	for (ToppingArrangement ta : written) {
+		text += ", {" + std::string(nameOf(ta.position, posNames)) + ": "
+			+ std::string(nameOf(ta.topping, topNames)) + "}";
+	}
+	return text + "]";
+}
+
+void OrderSession::write(std::ostream& out)
+{
+	out << "SPL SESSION 1\n";
+	out << "NAME " << std::quoted(session_name.text()) << '\n';
+	out << "NEXT " << next_id << '\n';
+	for (std::size_t slot = 0; slot < slots(); ++slot) {
+		if (!live[slot]) continue;
+		settle(slot);
+		out << "ORDER " << ids[slot] << ' ' << std::quoted(names[slot].text()) << ' ' << pizzaText(pizza(slot), written(slot)) << '\n';
+
+		VoteCounts vc(vote_counts.begin(slot), vote_counts.end(slot));
+		std::sort(vc.begin(), vc.end(), [](const ReplicaCount& rc1, const ReplicaCount& rc2) { // (so equal sessions save the same)
+			return rc1.replica.text() < rc2.replica.text();
+		});
+		for (const ReplicaCount& rc : vc) {
+			out << "VOTES " << std::quoted(rc.replica.text()) << ' ' << rc.up << ' ' << rc.down << '\n';
+		}
+	}
+	for (auto [kind, box] : {std::pair{"RANKED", &ranked_ballots}, std::pair{"APPROVAL", &approval_ballots}}) {
+		for (std::size_t b = 0; b < box->size(); ++b) {
+			out << "BALLOT " << kind;
+			for (const int* p = box->begin(b); p != box->end(b); ++p) out << ' ' << *p;
+			out << '\n';
+		}
+	}
+	std::vector<VoterTable::Entry> current;
+	voters.forEach([&](const VoterTable::Entry& e) {
+		if (e.epoch == epoch && e.id && locate(e.id) != npos) current.push_back(e);
+	});
+	std::sort(current.begin(), current.end(), [](const VoterTable::Entry& e1, const VoterTable::Entry& e2) {
+		return e1.voter.text() < e2.voter.text();
+	});
+	for (const VoterTable::Entry& e : current) {
+		out << "VOTER " << std::quoted(e.voter.text()) << ' ' << e.id << ' ' << e.amount << '\n';
+	}
+	out << "END\n";
+}
+
+OrderSession OrderSession::read(std::istream& in)
+{
+	auto fail = [](const std::string& why) { throw std::runtime_error(why); };
+	auto expect = [&](const char* word) {
+		std::string got;
+		if (!(in >> got) || got != word) fail(std::string("Expected \"") + word + "\" but found \"" + got + "\"");
+	};
+
+	int version = 0;
+	expect("SPL");
+	expect("SESSION");
+	if (!(in >> version) || version != 1) fail("Unsupported version of the session file format");
+
+	std::string name;
+	int next = 0;
+	expect("NAME");
+	if (!(in >> std::quoted(name))) fail("Malformed session name");
+	expect("NEXT");
+	if (!(in >> next) || next < 1) fail("Malformed next ID");
+
+	OrderSession os(Symbol::of(name));
+	std::string record;
+	while (in >> record && record != "END") {
+		if (record == "ORDER") {
+
+			int id = 0;
+			std::string order_name, pizza_text;
+			in >> id >> std::quoted(order_name) >> std::ws;
+			std::getline(in, pizza_text, ']');
+			if (!in || pizza_text.empty() || pizza_text.front() != '[') fail("Malformed order after #" + std::to_string(os.next_id - 1));
+			if (id < os.next_id || id >= next) fail("Order #" + std::to_string(id) + " is out of sequence");
+
+			Pizza p{};
+			ToppingOrder written;
+			try {
+				p = parser::interpretPizza(pizza_text + "]");
+				written = parser::writtenToppings(pizza_text + "]");
+			} catch (...) { // (the pizza parser throws several kinds of thing, depending on what's wrong)
+				fail("Order #" + std::to_string(id) + " has a malformed pizza");
+			}
+			os.next_id = id; // (the IDs in between belonged to orders that were removed)
+			os.slot_of.resize(id - os.first_id, npos);
+			os.add(p, Symbol::of(order_name), written);
+
+		} else if (record == "VOTES") {
+
+			ReplicaCount rc;
+			std::string replica;
+			in >> std::quoted(replica) >> rc.up >> rc.down;
+			if (!in || rc.up < 0 || rc.down < 0 || os.slots() == 0) fail("Malformed votes after #" + std::to_string(os.next_id - 1));
+			rc.replica = Symbol::of(replica);
+
+			std::size_t slot = os.slots() - 1;
+			VoteCounts vc(os.vote_counts.begin(slot), os.vote_counts.end(slot));
+			for (const ReplicaCount& seen : vc) {
+				if (seen.replica == rc.replica) fail("Order #" + std::to_string(os.ids.back()) + " has two counters for \"" + replica + "\"");
+			}
+			vc.push_back(rc);
+			os.vote_counts.assign(slot, vc.begin(), vc.end());
+			os.votes.back() = static_cast<int>(os.votes.back() + rc.up - rc.down);
+
+		} else if (record == "BALLOT") {
+
+			std::string kind, line;
+			in >> kind;
+			std::getline(in, line);
+			if (kind != "RANKED" && kind != "APPROVAL") fail("Unknown kind of ballot \"" + kind + "\"");
+
+			std::istringstream prefs(line);
+			std::vector<int> ids;
+			for (int id; prefs >> id;) {
+				if (id < 1 || id >= next) fail("A ballot lists #" + std::to_string(id) + ", which is out of range");
+				ids.push_back(id);
+			}
+			if (!prefs.eof() || ids.empty()) fail("Malformed ballot");
+			(kind == "RANKED" ? os.ranked_ballots : os.approval_ballots).cast(ids);
+
+		} else if (record == "VOTER") {
+
+			std::string voter;
+			VoterTable::Entry e;
+			in >> std::quoted(voter) >> e.id >> e.amount;
+			if (!in || voter.empty()) fail("Malformed voter");
+			if (os.locate(e.id) == npos) fail("\"" + voter + "\" voted for #" + std::to_string(e.id) + ", which isn't in the session");
+			e.voter = Symbol::of(voter);
+			e.epoch = os.epoch;
+			os.voters[e.voter] = e; // (their votes were loaded with the counters, so there's nothing to cast)
+
+		} else {
+			fail("Unexpected \"" + record + "\"");
+		}
+	}
+	if (record != "END") fail("Expected \"END\" before the end of the file");
+
+	os.next_id = next;
+	os.slot_of.resize(next - os.first_id, npos);
+	os.reindex(); // (for the leaderboard, since the votes came after the orders were indexed)
+	return os;
+}
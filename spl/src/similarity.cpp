@@ -0,0 +1,52 @@
+#include "similarity.hpp"
+
+namespace {
+
+	constexpr ToppingMask positionBits(int offset) // Every arrangement bit for the position at offset (0 to positionCount - 1)
+	{
+		ToppingMask tm{0, 0};
+		for (std::size_t b = offset; b < ToppingSet::capacity; b += positionCount) tm[b / 64] |= std::uint64_t{1} << (b % 64);
+		return tm;
+	}
+
+	constexpr ToppingMask leftBits = positionBits(static_cast<int>(ToppingPosition::LEFT) - 1);
+	constexpr ToppingMask rightBits = positionBits(static_cast<int>(ToppingPosition::RIGHT) - 1);
+	constexpr int allToLeft = static_cast<int>(ToppingPosition::ALL) - static_cast<int>(ToppingPosition::LEFT);
+	constexpr int allToRight = static_cast<int>(ToppingPosition::ALL) - static_cast<int>(ToppingPosition::RIGHT);
+
+	ToppingMask shiftDown(const ToppingMask& tm, int k) // (0 < k < 64)
+	{
+		return ToppingMask{tm[0] >> k | tm[1] << (64 - k), tm[1] >> k};
+	}
+
+	int popcount(const ToppingMask& tm) { return bitCount(tm[0]) + bitCount(tm[1]); }
+
+}
+
+ToppingMask halvesOf(const ToppingMask& tm)
+{
+	ToppingMask to_left = shiftDown(tm, allToLeft), to_right = shiftDown(tm, allToRight);
+	ToppingMask halves;
+	for (int w = 0; w < 2; ++w) {
+		halves[w] = ((tm[w] | to_left[w]) & leftBits[w]) | ((tm[w] | to_right[w]) & rightBits[w]);
+	}
+	return halves;
+}
+
+Similarity similarity(const Pizza& p1, const Pizza& p2)
+{
+	return similarity(p1, halvesOf(p1.toppings.mask()), p2);
+}
+
+Similarity similarity(const Pizza& p1, const ToppingMask& halves1, const Pizza& p2)
+{
+	ToppingMask halves2 = halvesOf(p2.toppings.mask());
+	Similarity s;
+	s.shared = popcount({halves1[0] & halves2[0], halves1[1] & halves2[1]});
+	s.total = popcount({halves1[0] | halves2[0], halves1[1] | halves2[1]});
+
+	int base_matches = (p1.crust == p2.crust) + (p1.sauce == p2.sauce) + (p1.cheese == p2.cheese);
+	s.shared += 2 * base_matches;
+	s.total += 2 * base_matches + 4 * (3 - base_matches); // (a mismatched base element is two features, one from each)
+	return s;
+}
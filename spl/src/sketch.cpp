@@ -0,0 +1,169 @@
+#include "sketch.hpp"
+#include <algorithm>
+#include <cmath>
+
+/* HyperLogLog */
+
+void HyperLogLog::add(std::uint64_t hash)
+{
+	std::size_t bucket = hash >> (64 - precision);
+	std::uint64_t rest = hash << precision | std::uint64_t{1} << (precision - 1); // (the sentinel bit caps the run)
+	auto rank = static_cast<std::uint8_t>(64 - highestBit(rest)); // (one more than its leading zeros)
+	registers[bucket] = std::max(registers[bucket], rank);
+}
+
+std::uint64_t HyperLogLog::estimate() const
+{
+	constexpr double m = std::size_t{1} << precision;
+	double sum = 0;
+	std::size_t zeros = 0;
+	for (std::uint8_t r : registers) {
+		sum += std::ldexp(1.0, -r);
+		if (r == 0) ++zeros;
+	}
+
+	double raw = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+	if (raw <= 2.5 * m && zeros) { // few enough items that counting the empty buckets is more accurate
+		raw = m * std::log(m / zeros);
+	}
+	return static_cast<std::uint64_t>(std::llround(raw));
+}
+
+void HyperLogLog::clear()
+{
+	registers.fill(0);
+}
+
+/* SpaceSaving */
+
+SpaceSaving::SpaceSaving(std::size_t _k) : k{std::max<std::size_t>(_k, 1)}
+{
+	counters.reserve(k);
+	heap.reserve(k);
+	heap_pos.reserve(k);
+	by_fingerprint.reserve(k);
+}
+
+void SpaceSaving::place(std::size_t i, std::uint32_t c)
+{
+	heap[i] = c;
+	heap_pos[c] = static_cast<std::uint32_t>(i);
+}
+
+void SpaceSaving::siftDown(std::size_t i)
+{
+	std::uint32_t c = heap[i];
+	for (;;) {
+		std::size_t child = 2 * i + 1;
+		if (child >= heap.size()) break;
+		if (child + 1 < heap.size() && counters[heap[child + 1]].count < counters[heap[child]].count) ++child;
+		if (counters[heap[child]].count >= counters[c].count) break;
+		place(i, heap[child]);
+		i = child;
+	}
+	place(i, c);
+}
+
+void SpaceSaving::add(const Pizza& p, std::int64_t votes)
+{
+	if (votes <= 0) return;
+	seen += votes;
+
+	std::uint64_t fp = fingerprint(p);
+	auto [first, last] = by_fingerprint.equal_range(fp);
+	for (auto it = first; it != last; ++it) {
+		if (counters[it->second].pizza == p) {
+			counters[it->second].count += votes;
+			siftDown(heap_pos[it->second]);
+			return;
+		}
+	}
+
+	if (counters.size() < k) { // there's still a free counter
+		auto c = static_cast<std::uint32_t>(counters.size());
+		counters.push_back(Counter{p, votes, 0});
+		heap.push_back(c);
+		heap_pos.push_back(0);
+		std::size_t i = heap.size() - 1;
+		while (i > 0 && counters[heap[(i - 1) / 2]].count > votes) { // sift it up
+			place(i, heap[(i - 1) / 2]);
+			i = (i - 1) / 2;
+		}
+		place(i, c);
+		by_fingerprint.emplace(fp, c);
+		return;
+	}
+
+	std::uint32_t c = heap[0]; // the pizza takes over the counter with the fewest votes
+	Counter& least = counters[c];
+	auto [lfirst, llast] = by_fingerprint.equal_range(fingerprint(least.pizza));
+	for (auto it = lfirst; it != llast; ++it) {
+		if (it->second == c) {
+			by_fingerprint.erase(it);
+			break;
+		}
+	}
+	least.pizza = p;
+	least.error = least.count;
+	least.count += votes;
+	by_fingerprint.emplace(fp, c);
+	siftDown(0);
+}
+
+std::vector<SpaceSaving::Counter> SpaceSaving::top(std::size_t n) const
+{
+	std::vector<std::uint32_t> order(counters.size());
+	for (std::uint32_t c = 0; c < order.size(); ++c) order[c] = c;
+	n = std::min(n, order.size());
+
+	auto more = [&](std::uint32_t c1, std::uint32_t c2) { // ties go to the surer count, then to the earlier counter
+		if (counters[c1].count != counters[c2].count) return counters[c1].count > counters[c2].count;
+		if (counters[c1].error != counters[c2].error) return counters[c1].error < counters[c2].error;
+		return c1 < c2;
+	};
+	std::partial_sort(order.begin(), order.begin() + n, order.end(), more);
+
+	std::vector<Counter> result;
+	result.reserve(n);
+	for (std::size_t i = 0; i < n; ++i) result.push_back(counters[order[i]]);
+	return result;
+}
+
+std::int64_t SpaceSaving::total() const
+{
+	return seen;
+}
+
+std::int64_t SpaceSaving::floor() const
+{
+	return counters.size() < k ? 0 : counters[heap[0]].count;
+}
+
+std::size_t SpaceSaving::capacity() const
+{
+	return k;
+}
+
+void SpaceSaving::clear()
+{
+	counters.clear();
+	heap.clear();
+	heap_pos.clear();
+	by_fingerprint.clear();
+	seen = 0;
+}
+
+/* VoteSketch */
+
+void VoteSketch::vote(const Pizza& p, std::int64_t amount)
+{
+	pizzas.add(fingerprint(p)); // (a pizza given no votes has still been voted on)
+	if (amount > 0) top.add(p, amount);
+}
+
+void VoteSketch::clear()
+{
+	top.clear();
+	pizzas.clear();
+	voters.clear();
+}
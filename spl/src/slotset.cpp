@@ -0,0 +1,188 @@
+#include "slotset.hpp"
+#include <algorithm>
+#include <iterator>
+
+bool SlotSet::Chunk::contains(std::uint16_t l) const
+{
+	if (dense()) return (bits[l / 64] >> (l % 64)) & 1;
+	return std::binary_search(low.begin(), low.end(), l);
+}
+
+void SlotSet::Chunk::densify()
+{
+	bits.assign(65536 / 64, 0);
+	for (std::uint16_t l : low) bits[l / 64] |= std::uint64_t{1} << (l % 64);
+	low = std::vector<std::uint16_t>(); // (clear wouldn't give the memory back)
+}
+
+void SlotSet::Chunk::sparsify()
+{
+	low.clear();
+	low.reserve(count);
+	for (std::size_t w = 0; w < bits.size(); ++w) {
+		for (std::uint64_t word = bits[w]; word; word &= word - 1) {
+			low.push_back(static_cast<std::uint16_t>(w * 64 + lowestBit(word)));
+		}
+	}
+	bits = std::vector<std::uint64_t>();
+}
+
+std::vector<SlotSet::Chunk>::iterator SlotSet::chunkFor(std::uint32_t key)
+{
+	return std::lower_bound(chunks.begin(), chunks.end(), key, [](const Chunk& c, std::uint32_t k) { return c.key < k; });
+}
+
+std::vector<SlotSet::Chunk>::const_iterator SlotSet::chunkFor(std::uint32_t key) const
+{
+	return std::lower_bound(chunks.begin(), chunks.end(), key, [](const Chunk& c, std::uint32_t k) { return c.key < k; });
+}
+
+bool SlotSet::contains(std::size_t slot) const
+{
+	auto c = chunkFor(static_cast<std::uint32_t>(slot >> 16));
+	return c != chunks.end() && c->key == (slot >> 16) && c->contains(static_cast<std::uint16_t>(slot));
+}
+
+void SlotSet::insert(std::size_t slot)
+{
+	auto key = static_cast<std::uint32_t>(slot >> 16);
+	auto l = static_cast<std::uint16_t>(slot);
+
+	auto c = (!chunks.empty() && chunks.back().key == key) ? std::prev(chunks.end()) : chunkFor(key); // slots mostly arrive in order
+	if (c == chunks.end() || c->key != key) c = chunks.insert(c, Chunk{key, 0, {}, {}});
+
+	if (c->dense()) {
+		std::uint64_t& word = c->bits[l / 64];
+		std::uint64_t bit = std::uint64_t{1} << (l % 64);
+		if (word & bit) return;
+		word |= bit;
+	} else {
+		auto at = (c->low.empty() || c->low.back() < l) ? c->low.end() : std::lower_bound(c->low.begin(), c->low.end(), l);
+		if (at != c->low.end() && *at == l) return;
+		c->low.insert(at, l);
+	}
+	++c->count;
+	++count;
+	if (!c->dense() && c->count > denseAbove) c->densify();
+}
+
+void SlotSet::erase(std::size_t slot)
+{
+	auto key = static_cast<std::uint32_t>(slot >> 16);
+	auto l = static_cast<std::uint16_t>(slot);
+
+	auto c = chunkFor(key);
+	if (c == chunks.end() || c->key != key) return;
+
+	if (c->dense()) {
+		std::uint64_t& word = c->bits[l / 64];
+		std::uint64_t bit = std::uint64_t{1} << (l % 64);
+		if (!(word & bit)) return;
+		word &= ~bit;
+	} else {
+		auto at = std::lower_bound(c->low.begin(), c->low.end(), l);
+		if (at == c->low.end() || *at != l) return;
+		c->low.erase(at);
+	}
+	--c->count;
+	--count;
+	if (!c->count) {
+		chunks.erase(c);
+	} else if (c->dense() && c->count < sparseBelow) {
+		c->sparsify();
+	}
+}
+
+void SlotSet::clear()
+{
+	chunks.clear();
+	count = 0;
+}
+
+std::size_t SlotSet::size() const { return count; }
+bool SlotSet::empty() const { return count == 0; }
+
+std::size_t SlotSet::first() const
+{
+	const Chunk& c = chunks.front();
+	std::size_t high = std::size_t{c.key} << 16;
+	if (!c.dense()) return high | c.low.front();
+	std::size_t w = 0;
+	while (!c.bits[w]) ++w;
+	return high | (w * 64 + lowestBit(c.bits[w]));
+}
+
+SlotSet& SlotSet::operator&=(const SlotSet& other)
+{
+	std::vector<Chunk> kept;
+	count = 0;
+	auto theirs = other.chunks.begin();
+
+	for (Chunk& c : chunks) {
+		while (theirs != other.chunks.end() && theirs->key < c.key) ++theirs;
+		if (theirs == other.chunks.end()) break;
+		if (theirs->key != c.key) continue;
+		const Chunk& t = *theirs;
+
+		if (c.dense() && t.dense()) {
+			c.count = 0;
+			for (std::size_t w = 0; w < c.bits.size(); ++w) {
+				c.bits[w] &= t.bits[w];
+				c.count += bitCount(c.bits[w]);
+			}
+			if (c.count && c.count < sparseBelow) c.sparsify();
+		} else if (c.dense() || (!t.dense() && t.count < c.count)) { // only their slots can survive, so look each of them up in ours
+			std::vector<std::uint16_t> both;
+			for (std::uint16_t l : t.low) {
+				if (c.contains(l)) both.push_back(l);
+			}
+			c.bits = std::vector<std::uint64_t>();
+			c.low = std::move(both);
+			c.count = static_cast<std::uint32_t>(c.low.size());
+		} else { // the same, but with ours as the smaller side
+			auto last = std::remove_if(c.low.begin(), c.low.end(), [&t](std::uint16_t l) { return !t.contains(l); });
+			c.low.erase(last, c.low.end());
+			c.count = static_cast<std::uint32_t>(c.low.size());
+		}
+
+		if (c.count) {
+			count += c.count;
+			kept.push_back(std::move(c));
+		}
+	}
+
+	chunks = std::move(kept);
+	return *this;
+}
+
+SlotSet& SlotSet::operator|=(const SlotSet& other)
+{
+	for (const Chunk& t : other.chunks) {
+		auto c = chunkFor(t.key);
+		if (c == chunks.end() || c->key != t.key) {
+			count += t.count;
+			chunks.insert(c, t);
+			continue;
+		}
+
+		count -= c->count;
+		if (!c->dense() && !t.dense() && c->count + t.count <= denseAbove) {
+			std::vector<std::uint16_t> either;
+			either.reserve(c->count + t.count);
+			std::set_union(c->low.begin(), c->low.end(), t.low.begin(), t.low.end(), std::back_inserter(either));
+			c->low = std::move(either);
+			c->count = static_cast<std::uint32_t>(c->low.size());
+		} else {
+			if (!c->dense()) c->densify();
+			if (t.dense()) {
+				for (std::size_t w = 0; w < c->bits.size(); ++w) c->bits[w] |= t.bits[w];
+			} else {
+				for (std::uint16_t l : t.low) c->bits[l / 64] |= std::uint64_t{1} << (l % 64);
+			}
+			c->count = 0;
+			for (std::uint64_t word : c->bits) c->count += bitCount(word);
+		}
+		count += c->count;
+	}
+	return *this;
+}
@@ -1,30 +1,76 @@
 #include "printer.hpp"
 #include "program.hpp"
+#include "modules.hpp"
 
 #include <iostream>
+#include <sstream>
+#include <limits>
+#include <numeric>
+
+static std::string noSuchPizza(const OrderSession& os, const PizzaSpecifier& pspec) // The error for a lookup that found nothing,
+{                                                                                  // which suggests the nearest order to a pizza
+	std::string error = "Error: No such pizza has been ordered.";
+	const Pizza* p = std::get_if<Pizza>(&pspec);
+	if (!p) return error;
+
+	auto near = os.nearest(*p, 1);
+	if (near.empty()) return error;
+	auto [slot, sim] = near.front();
+	std::ostringstream hint;
+	hint << " (Did you mean #" << os.ids[slot];
+	if (!os.names[slot].empty()) hint << " \"" << os.names[slot] << "\"";
+	hint << ", which is " << sim.percent() << "% alike?)";
+	return error + hint.str();
+}
+
+static std::string inBatch(std::string error, std::size_t i, std::size_t n) // Says which vote of a batch an error is about
+{
+	return error.insert(std::string("Error: ").size(), "Vote " + std::to_string(i + 1) + " of " + std::to_string(n) + ": ");
+}
 
-int StartSession::execute(ProgramState& ps)
+static bool exactVotes(ProgramState& ps) // Reports an error if the session only counts its votes approximately
+{
+	if (!ps.session->sketch) return true;
+	printer::reportRuntimeError("Error: An approximate session doesn't keep exact votes.", ps);
+	return false;
+}
+
+static void logSketchUndo(ProgramState& ps) // Nothing can be taken back out of a sketch, so a rollback restores the copy taken when
+{                                           // the transaction first changed it (anything that replaces the session since puts it back)
+	if (!ps.undolog || ps.sketch_kept) return;
+	ps.sketch_kept = true;
+	ps.logUndo([before = *ps.session->sketch](ProgramState& ps) { ps.session->sketch = before; });
+}
+
+int run::startSession(ProgramState& ps, Symbol name, int reserves, int approximate)
 {
 	if (ps.session) {
 		printer::reportRuntimeError("Error: A session is already active.", ps);
 		return 1;
 	} else {
 		ps.session = OrderSession(name, reserves);
+		ps.session->replica = ps.replica;
+		if (approximate) ps.session->sketch.emplace(approximate);
+		ps.logUndo([](ProgramState& ps) { ps.session.reset(); });
 		return 0;
 	}
 }
 
-int NameSession::execute(ProgramState& ps)
+int run::nameSession(ProgramState& ps, Symbol name)
 {
-	if (ps.session)
-	ps.session->session_name = name;
+	if (ps.session) {
+		ps.logUndo([old = ps.session->session_name](ProgramState& ps) { ps.session->session_name = old; });
+		ps.session->session_name = name;
+	}
 	return 0;
 }
 
-int EndSession::execute(ProgramState& ps)
+int run::endSession(ProgramState& ps)
 {
 	if (ps.session) {
+		auto ended = std::make_shared<OrderSession>(std::move(*ps.session));
 		ps.session.reset();
+		ps.logUndo([ended](ProgramState& ps) { ps.session = std::move(*ended); });
 		return 0;
 	} else {
 		printer::reportRuntimeError("Error: No session active.", ps);
@@ -33,24 +79,77 @@ int EndSession::execute(ProgramState& ps)
 	return 0;
 }
 
-int SaveSession::execute(ProgramState& ps)
+static std::optional<OrderSession> readSession(const std::string& filepath, ProgramState& ps) // Reports why, if it can't
 {
-	printer::copy("Session saving has not been implemented yet.");
-	printer::lineBreak();
-	return 0;
+	std::ifstream in(filepath);
+	if (!in) {
+		printer::reportRuntimeError("Error: File \"" + filepath + "\" does not exist.", ps);
+		return std::nullopt;
+	}
+	try {
+		return OrderSession::read(in);
+	} catch (std::runtime_error& re) {
+		printer::reportRuntimeError("Error: \"" + filepath + "\" is not a saved session. (" + re.what() + ")", ps);
+		return std::nullopt;
+	}
 }
 
-int LoadSession::execute(ProgramState& ps)
+int run::saveSession(ProgramState& ps, const std::string& filepath)
 {
-	printer::copy("Session loading has not been implemented yet.");
-	printer::lineBreak();
-	return 0;
+	if (ps.session) {
+		if (!exactVotes(ps)) return 1;
+		std::ofstream out(filepath);
+		if (out) ps.session->write(out);
+		if (!out) {
+			printer::reportRuntimeError("Error: Could not write to \"" + filepath + "\".", ps);
+			return 1;
+		}
+		return 0;
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+}
+
+int run::loadSession(ProgramState& ps, const std::string& filepath)
+{
+	if (auto loaded = readSession(filepath, ps)) {
+		if (ps.undolog) { // the current session (if any) ends, but it has to be kept in case this is rolled back
+			auto before = std::make_shared<std::optional<OrderSession>>(std::move(ps.session));
+			ps.logUndo([before](ProgramState& ps) { ps.session = std::move(*before); });
+		}
+		ps.session = std::move(*loaded);
+		ps.session->replica = ps.replica; // (votes cast from here on are this instance's, whoever cast the ones loaded)
+		return 0;
+	} else {
+		return 1;
+	}
+}
+
+int run::mergeSession(ProgramState& ps, const std::string& filepath)
+{
+	if (!ps.session) {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	} else if (!exactVotes(ps)) {
+		return 1;
+	} else if (auto other = readSession(filepath, ps)) {
+		if (ps.undolog) {
+			auto before = std::make_shared<OrderSession>(*ps.session);
+			ps.logUndo([before](ProgramState& ps) { *ps.session = std::move(*before); });
+		}
+		ps.session->merge(*other);
+		return 0;
+	} else {
+		return 1;
+	}
 }
 
-int AddPizza::execute(ProgramState& ps)
+int run::addPizza(ProgramState& ps, const Pizza& p, const ToppingOrder& written, Symbol name)
 {
 	if (ps.session) {
-		ps.session->orders.push_back(PizzaOrder{p, name});
+		ps.session->add(p, name, written);
+		ps.logUndo([](ProgramState& ps) { ps.session->removeLast(); });
 		return 0;
 	} else {
 		printer::reportRuntimeError("Error: No session active.", ps);
@@ -59,11 +158,22 @@ int AddPizza::execute(ProgramState& ps)
 	return 0;
 }
 
-int RemovePizza::execute(ProgramState& ps)
+int run::removePizza(ProgramState& ps, const PizzaSpecifier& pspec)
 {
 	if (ps.session) {
-		std::visit([&](auto&& arg) { ps.session->orders.erase(ps.session->locateIt(arg)); }, pspec);
-		return 0;
+
+		auto slot = std::visit([&](auto&& arg) { return ps.session->locate(arg); }, pspec);
+		if (slot != OrderSession::npos) {
+			ps.logUndo([id = ps.session->ids[slot], po = ps.session->order(slot), counts = ps.session->counts(slot)](ProgramState& ps) {
+				ps.session->reinstate(id, po, counts);
+			});
+			ps.session->remove(slot);
+			return 0;
+		} else {
+			printer::reportRuntimeError(noSuchPizza(*ps.session, pspec), ps);
+			return 1;
+		}
+
 	} else {
 		printer::reportRuntimeError("Error: No session active.", ps);
 		return 1;
@@ -72,7 +182,24 @@ int RemovePizza::execute(ProgramState& ps)
 	return 0;
 }
 
-int ViewPizza::execute(ProgramState& ps)
+int run::removePizzaWhere(ProgramState& ps, const Filter& where)
+{
+	if (ps.session) {
+		if (where.onVotes() && !exactVotes(ps)) return 1;
+		SlotSet doomed = where.select(*ps.session);
+		if (ps.undolog && !doomed.empty()) { // putting many orders back one by one would cost more than keeping a copy
+			auto before = std::make_shared<OrderSession>(*ps.session);
+			ps.logUndo([before](ProgramState& ps) { *ps.session = std::move(*before); });
+		}
+		ps.session->remove(doomed);
+		return 0;
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+}
+
+int run::viewPizza(ProgramState& ps, const PizzaSpecifier& pspec, bool details, bool all)
 {
 	if (ps.session) {
 
@@ -86,22 +213,20 @@ int ViewPizza::execute(ProgramState& ps)
 			printer::lineBreak();
 		} else { // show only the selected pizza
 	
-			if (std::visit([&](auto&& arg) { return ps.session->located(arg); }, pspec)) {
-
-				std::visit([&](auto&& arg) { 
+			auto slot = std::visit([&](auto&& arg) { return ps.session->locate(arg); }, pspec);
+			if (slot != OrderSession::npos) {
 
-					if (details) {
-						printer::showOrderWithInfo(ps.session->locate(arg), ps.session->locateIndex(arg));
-					} else {
-						printer::showOrder(ps.session->locate(arg), ps.session->locateIndex(arg));
-					} 
-					printer::lineBreak();
-				}, pspec);
+				if (details) {
+					printer::showOrderWithInfo(ps.session->order(slot), ps.session->ids[slot]);
+				} else {
+					printer::showOrder(ps.session->order(slot), ps.session->ids[slot]);
+				} 
+				printer::lineBreak();
 
 				return 0;
 
 			} else {
-				printer::reportRuntimeError("Error: No such pizza has been ordered.", ps);
+				printer::reportRuntimeError(noSuchPizza(*ps.session, pspec), ps);
 				return 1;
 			}
 
@@ -114,15 +239,100 @@ int ViewPizza::execute(ProgramState& ps)
 	return 0;
 }
 
-int VotePizza::execute(ProgramState& ps)
+int run::viewPizzaWithTopping(ProgramState& ps, ToppingArrangement ta, bool details)
 {
 	if (ps.session) {
+		printer::showMatchingOrders(*ps.session, ps.session->withTopping(ta), details);
+		printer::lineBreak();
+		return 0;
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+}
+
+int run::viewPizzaNearest(ProgramState& ps, const Pizza& p, int n, bool details)
+{
+	if (ps.session) {
+		if (n < 0) {
+			printer::reportRuntimeError("Error: Number of selections must be non-negative.", ps);
+			return 1;
+		} else {
+			printer::showNearestOrders(*ps.session, p, n, details);
+		}
 
-		if (std::visit([&](auto&& arg) { return ps.session->located(arg); }, pspec)) {
-			std::visit([&](auto&& arg) { ps.session->vote(arg, n); }, pspec);
+		printer::lineBreak();
+		return 0;
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+}
+
+int run::viewPizzaWhere(ProgramState& ps, const Filter& where, bool details)
+{
+	if (ps.session) {
+		if (where.onVotes() && !exactVotes(ps)) return 1;
+		printer::showMatchingOrders(*ps.session, where.select(*ps.session), details);
+		printer::lineBreak();
+		return 0;
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+}
+
+int run::viewPizzaLike(ProgramState& ps, const std::string& pattern, bool details)
+{
+	if (ps.session) {
+		printer::showMatchingOrders(*ps.session, ps.session->like(pattern), details);
+		printer::lineBreak();
+		return 0;
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+}
+
+int run::votePizza(ProgramState& ps, const PizzaSpecifier& pspec, int n, Symbol voter)
+{
+	if (ps.session && ps.session->sketch) {
+
+		if (n < 0) {
+			printer::reportRuntimeError("Error: Votes can't be taken back in an approximate session.", ps);
+			return 1;
+		}
+		const Pizza* p = std::get_if<Pizza>(&pspec); // (a pizza can be voted for without being ordered, since only its votes are kept)
+		if (!p) {
+			auto slot = std::visit([&](auto&& arg) { return ps.session->locate(arg); }, pspec);
+			if (slot == OrderSession::npos) {
+				printer::reportRuntimeError(noSuchPizza(*ps.session, pspec), ps);
+				return 1;
+			}
+			p = &ps.session->pizza(slot);
+		}
+		logSketchUndo(ps);
+		ps.session->sketch->vote(*p, n);
+		if (!voter.empty()) ps.session->sketch->voters.add(mixBits(voter.id));
+		return 0;
+
+	} else if (ps.session) {
+
+		auto slot = std::visit([&](auto&& arg) { return ps.session->locate(arg); }, pspec);
+		if (slot != OrderSession::npos && !voter.empty()) { // the voter's previous vote (if any) is replaced
+			VoterTable::Entry before = ps.session->voteAs(voter, slot, n);
+			ps.logUndo([before, current = before.epoch == ps.session->epoch](ProgramState& ps) {
+				VoterTable::Entry e = before; // (a reset that's been undone since has moved the epoch on, but not really reset it)
+				if (current) e.epoch = ps.session->epoch;
+				ps.session->setVoter(e);
+			});
+			return 0;
+		} else if (slot != OrderSession::npos) {
+			ps.session->vote(slot, n);
+			ps.logUndo([id = ps.session->ids[slot], n = n](ProgramState& ps) { ps.session->vote(ps.session->locate(id), -n); });
 			return 0;
 		} else {
-			printer::reportRuntimeError("Error: No such pizza has been ordered.", ps);
+			printer::reportRuntimeError(noSuchPizza(*ps.session, pspec), ps);
 			return 1;
 		}
 
@@ -134,12 +344,162 @@ int VotePizza::execute(ProgramState& ps)
 	return 0;
 }
 
-int SelectTopPizza::execute(ProgramState& ps)
+static std::vector<std::size_t> locateAll(const OrderSession& os, const VoteList& votes) // The slot of each target, as written
+{
+	std::vector<std::size_t> order(votes.size()); // they're looked up sorted by kind and then by ID or name, so that repeats
+	std::iota(order.begin(), order.end(), 0);     // of a target come together and are only looked up once
+	std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+		const PizzaSpecifier& sa = votes[a].first;
+		const PizzaSpecifier& sb = votes[b].first;
+		if (sa.index() != sb.index()) return sa.index() < sb.index();
+		if (auto id = std::get_if<int>(&sa)) return *id < std::get<int>(sb);
+		if (auto name = std::get_if<Symbol>(&sa)) return name->id < std::get<Symbol>(sb).id;
+		return false; // (pizzas have no order, so they're left as written)
+	});
+
+	std::vector<std::size_t> slots(votes.size());
+	for (std::size_t k = 0; k < order.size(); ++k) {
+		std::size_t i = order[k];
+		if (k > 0 && votes[i].first == votes[order[k - 1]].first) {
+			slots[i] = slots[order[k - 1]];
+		} else {
+			slots[i] = std::visit([&](auto&& arg) { return os.locate(arg); }, votes[i].first);
+		}
+	}
+	return slots;
+}
+
+int run::votePizzas(ProgramState& ps, const VoteList& votes)
+{
+	if (ps.session && ps.session->sketch) {
+
+		std::vector<std::size_t> slots = locateAll(*ps.session, votes);
+		std::vector<const Pizza*> pizzas;
+		pizzas.reserve(votes.size());
+		for (std::size_t i = 0; i < votes.size(); ++i) { // every vote is checked before any is counted
+			auto& [pspec, n] = votes[i];
+			if (n < 0) {
+				printer::reportRuntimeError(inBatch("Error: Votes can't be taken back in an approximate session.", i, votes.size()), ps);
+				return 1;
+			}
+			const Pizza* p = std::get_if<Pizza>(&pspec); // (a pizza doesn't have to have been ordered, as in VotePizza)
+			if (!p) {
+				if (slots[i] == OrderSession::npos) {
+					printer::reportRuntimeError(inBatch(noSuchPizza(*ps.session, pspec), i, votes.size()), ps);
+					return 1;
+				}
+				p = &ps.session->pizza(slots[i]);
+			}
+			pizzas.push_back(p);
+		}
+		logSketchUndo(ps);
+		for (std::size_t i = 0; i < votes.size(); ++i) ps.session->sketch->vote(*pizzas[i], votes[i].second);
+		return 0;
+
+	} else if (ps.session) {
+
+		std::vector<std::size_t> slots = locateAll(*ps.session, votes);
+		for (std::size_t i = 0; i < votes.size(); ++i) {
+			if (slots[i] == OrderSession::npos) {
+				printer::reportRuntimeError(inBatch(noSuchPizza(*ps.session, votes[i].first), i, votes.size()), ps);
+				return 1;
+			}
+		}
+
+		std::vector<std::pair<std::size_t, int>> batch; // (slot, votes), applied in slot order with each order's votes added up,
+		batch.reserve(votes.size());                    // so an order voted for many times is only re-ranked once
+		for (std::size_t i = 0; i < votes.size(); ++i) batch.emplace_back(slots[i], votes[i].second);
+		std::sort(batch.begin(), batch.end());
+
+		auto fits = [](std::int64_t sum) { return std::numeric_limits<int>::min() <= sum && sum <= std::numeric_limits<int>::max(); };
+		std::vector<std::pair<int, int>> counted; // (ID, votes), only kept if there's a transaction to undo them in
+		for (std::size_t i = 0; i < batch.size();) {
+			auto [slot, amount] = batch[i++];
+			while (i < batch.size() && batch[i].first == slot && fits(std::int64_t{amount} + batch[i].second)) {
+				amount += batch[i++].second;
+			}
+			ps.session->vote(slot, amount);
+			if (ps.undolog) counted.emplace_back(ps.session->ids[slot], amount);
+		}
+		ps.logUndo([counted = std::move(counted)](ProgramState& ps) {
+			for (auto [id, n] : counted) ps.session->vote(ps.session->locate(id), -n);
+		});
+		return 0;
+
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+}
+
+int run::votePizzaWhere(ProgramState& ps, const Filter& where, int n)
+{
+	if (ps.session && ps.session->sketch) {
+		if (n < 0) {
+			printer::reportRuntimeError("Error: Votes can't be taken back in an approximate session.", ps);
+			return 1;
+		}
+		if (where.onVotes() && !exactVotes(ps)) return 1;
+		logSketchUndo(ps);
+		where.select(*ps.session).forEach([&](std::size_t slot) { ps.session->sketch->vote(ps.session->pizza(slot), n); });
+		return 0;
+	} else if (ps.session) {
+		std::vector<int> voted; // (only kept if there's a transaction to undo them in)
+		where.select(*ps.session).forEach([&](std::size_t slot) {
+			ps.session->vote(slot, n);
+			if (ps.undolog) voted.push_back(ps.session->ids[slot]);
+		});
+		ps.logUndo([voted = std::move(voted), n = n](ProgramState& ps) {
+			for (int id : voted) ps.session->vote(ps.session->locate(id), -n);
+		});
+		return 0;
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+}
+
+int run::castBallot(ProgramState& ps, const SpecifierList& prefs, bool ranked)
+{
+	if (ps.session) {
+		if (!exactVotes(ps)) return 1;
+
+		std::vector<int> ids; // (ballots hold IDs, so that they aren't disturbed by orders moving between slots)
+		ids.reserve(prefs.size());
+		for (const PizzaSpecifier& pspec : prefs) {
+			auto slot = std::visit([&](auto&& arg) { return ps.session->locate(arg); }, pspec);
+			if (slot == OrderSession::npos) {
+				printer::reportRuntimeError(noSuchPizza(*ps.session, pspec), ps);
+				return 1;
+			}
+			ids.push_back(ps.session->ids[slot]);
+		}
+		std::vector<int> sorted = ids;
+		std::sort(sorted.begin(), sorted.end());
+		if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+			printer::reportRuntimeError("Error: A ballot can't list the same pizza twice.", ps);
+			return 1;
+		}
+
+		(ranked ? ps.session->ranked_ballots : ps.session->approval_ballots).cast(ids);
+		ps.logUndo([ranked = ranked](ProgramState& ps) {
+			(ranked ? ps.session->ranked_ballots : ps.session->approval_ballots).uncast();
+		});
+		return 0;
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+}
+
+int run::selectTopPizza(ProgramState& ps, int n)
 {
 	if (ps.session) {
 		if (n < 0) {
 			printer::reportRuntimeError("Error: Number of selections must be non-negative.", ps);
 			return 1;
+		} else if (ps.session->sketch) {
+			printer::showApproximateTop(*ps.session, n);
 		} else {
 			printer::showTopOrders(*ps.session, n);
 		}
@@ -154,10 +514,99 @@ int SelectTopPizza::execute(ProgramState& ps)
 	return 0;
 }
 
-int ResetSessionVotes::execute(ProgramState& ps)
+int run::selectTopPizzaWhere(ProgramState& ps, int n, const Filter& where)
 {
 	if (ps.session) {
+		if (n < 0) {
+			printer::reportRuntimeError("Error: Number of selections must be non-negative.", ps);
+			return 1;
+		} else if (!exactVotes(ps)) {
+			return 1;
+		} else {
+			printer::showTopOrders(*ps.session, n, where.select(*ps.session));
+		}
+
+		printer::lineBreak();
+		return 0;
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+}
+
+int run::selectTopPizzaBy(ProgramState& ps, int n, Tally how)
+{
+	if (ps.session) {
+		if (n < 0) {
+			printer::reportRuntimeError("Error: Number of selections must be non-negative.", ps);
+			return 1;
+		} else {
+			printer::showStandings(*ps.session, n, how);
+		}
+
+		printer::lineBreak();
+		return 0;
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+}
+
+int run::aggregateIngredients(ProgramState& ps, int n, bool all, bool by_votes)
+{
+	if (ps.session) {
+		if ((by_votes || !all) && !exactVotes(ps)) {
+			return 1;
+		} else if (all) {
+			printer::showIngredients(ps.session->ingredients(by_votes), by_votes);
+		} else if (n < 0) {
+			printer::reportRuntimeError("Error: Number of selections must be non-negative.", ps);
+			return 1;
+		} else {
+			std::vector<std::size_t> top = ps.session->topSlots(n);
+			printer::showIngredients(ps.session->ingredients(by_votes, &top), by_votes);
+		}
+
+		printer::lineBreak();
+		return 0;
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+}
+
+int run::resetSessionVotes(ProgramState& ps)
+{
+	if (ps.session && ps.session->sketch) {
+		logSketchUndo(ps);
+		ps.session->sketch->clear();
+		return 0;
+	} else if (ps.session) {
+		if (ps.undolog) { // Orders can move between slots before this is undone, so the tallies are recorded by ID
+			std::vector<std::pair<int, int>> tallies;
+			for (std::size_t i = 0; i < ps.session->slots(); ++i) {
+				if (ps.session->live[i] && ps.session->tally(i)) tallies.emplace_back(ps.session->ids[i], ps.session->tally(i));
+			}
+			ps.logUndo([tallies](ProgramState& ps) {
+				for (const auto& [id, tally] : tallies) ps.session->setVote(ps.session->locate(id), tally);
+			});
+			std::vector<Symbol> current; // (and the voters whose votes those tallies include have them again)
+			ps.session->voters.forEach([&](const VoterTable::Entry& e) {
+				if (e.epoch == ps.session->epoch) current.push_back(e.voter);
+			});
+			ps.logUndo([current = std::move(current)](ProgramState& ps) {
+				for (Symbol v : current) ps.session->voters[v].epoch = ps.session->epoch;
+			});
+			auto boxes = std::make_shared<std::pair<BallotBox, BallotBox>>( // (the ballots go too)
+				std::move(ps.session->ranked_ballots), std::move(ps.session->approval_ballots));
+			ps.logUndo([boxes](ProgramState& ps) {
+				ps.session->ranked_ballots = std::move(boxes->first);
+				ps.session->approval_ballots = std::move(boxes->second);
+			});
+		}
 		ps.session->resetVotes();
+		ps.session->ranked_ballots.clear();
+		ps.session->approval_ballots.clear();
 		return 0;
 	} else {
 		printer::reportRuntimeError("Error: No session active.", ps);
@@ -167,10 +616,12 @@ int ResetSessionVotes::execute(ProgramState& ps)
 	return 0;
 }
 
-int ResetSession::execute(ProgramState& ps)
+int run::resetSession(ProgramState& ps)
 {
 	if (ps.session) {
-		ps.session->reset();
+		auto cleared = std::make_shared<OrderSession>(ps.session->fresh());
+		std::swap(*cleared, *ps.session); // leaves an empty session with the same name in place
+		ps.logUndo([cleared](ProgramState& ps) { ps.session = std::move(*cleared); });
 		return 0;
 	} else {
 		printer::reportRuntimeError("Error: No session active.", ps);
@@ -180,23 +631,28 @@ int ResetSession::execute(ProgramState& ps)
 	return 0;
 }
 
-int AlterPizzaAdd::execute(ProgramState& ps)
+int run::alterPizzaAdd(ProgramState& ps, const PizzaSpecifier& pspec, ToppingArrangement ta)
 {
 	if (ps.session) {
 
-		if (std::visit([&](auto&& arg) { return ps.session->located(arg); }, pspec)) {
+		auto slot = std::visit([&](auto&& arg) { return ps.session->locate(arg); }, pspec);
+		if (slot != OrderSession::npos) {
 
-			Pizza& pz = std::visit([&](auto&& arg) -> Pizza& { return ps.session->locate(arg).pizza; }, pspec);
-			if (containsItem(pz.toppings, ta)) {
+			Pizza pz = ps.session->pizza(slot);
+			if (pz.toppings.contains(ta)) {
 				printer::reportRuntimeError("Error: This topping arrangement is already on the pizza", ps);
 				return 1;
 			} else {
-				pz.toppings.push_back(ta);
+				ps.logUndo([id = ps.session->ids[slot], old = ps.session->pizza(slot), written = ps.session->written(slot)](ProgramState& ps) { 
+					ps.session->setPizza(ps.session->locate(id), old, written); 
+				});
+				pz.toppings.insert(ta);
+				ps.session->setPizza(slot, pz);
 				return 0;
 			}
 
 		} else {
-			printer::reportRuntimeError("Error: No such pizza has been ordered.", ps);
+			printer::reportRuntimeError(noSuchPizza(*ps.session, pspec), ps);
 			return 1;
 		}
 
@@ -208,17 +664,21 @@ int AlterPizzaAdd::execute(ProgramState& ps)
 	return 0;
 }
 
-int AlterPizzaRemove::execute(ProgramState& ps)
+int run::alterPizzaRemove(ProgramState& ps, const PizzaSpecifier& pspec, ToppingArrangement ta)
 {
 	if (ps.session) {
 
-		if (std::visit([&](auto&& arg) { return ps.session->located(arg); }, pspec)) {
-			Pizza& pz = std::visit([&](auto&& arg) -> Pizza& { return ps.session->locate(arg).pizza; }, pspec);
-			//std::erase(pz.toppings, ta); C++ 20 only
-			pz.toppings.erase(std::remove(pz.toppings.begin(), pz.toppings.end(), ta));
+		auto slot = std::visit([&](auto&& arg) { return ps.session->locate(arg); }, pspec);
+		if (slot != OrderSession::npos) {
+			Pizza pz = ps.session->pizza(slot);
+			ps.logUndo([id = ps.session->ids[slot], old = ps.session->pizza(slot), written = ps.session->written(slot)](ProgramState& ps) { 
+				ps.session->setPizza(ps.session->locate(id), old, written); // (so a topping put back goes back where it was)
+			});
+			pz.toppings.erase(ta);
+			ps.session->setPizza(slot, pz);
 			return 0;
 		} else {
-			printer::reportRuntimeError("Error: No such pizza has been ordered.", ps);
+			printer::reportRuntimeError(noSuchPizza(*ps.session, pspec), ps);
 			return 1;
 		}
 
@@ -230,16 +690,21 @@ int AlterPizzaRemove::execute(ProgramState& ps)
 	return 0;
 }
 
-int AlterPizzaSetCrust::execute(ProgramState& ps)
+int run::alterPizzaSetCrust(ProgramState& ps, const PizzaSpecifier& pspec, Crust c)
 {
 	if (ps.session) {
 
-		if (std::visit([&](auto&& arg) { return ps.session->located(arg); }, pspec)) {
-			Pizza& pz = std::visit([&](auto&& arg) -> Pizza& { return ps.session->locate(arg).pizza; }, pspec);
+		auto slot = std::visit([&](auto&& arg) { return ps.session->locate(arg); }, pspec);
+		if (slot != OrderSession::npos) {
+			Pizza pz = ps.session->pizza(slot);
+			ps.logUndo([id = ps.session->ids[slot], old = ps.session->pizza(slot)](ProgramState& ps) { 
+				ps.session->setPizza(ps.session->locate(id), old); 
+			});
 			pz.crust = c;
+			ps.session->setPizza(slot, pz);
 			return 0;
 		} else {
-			printer::reportRuntimeError("Error: No such pizza has been ordered.", ps);
+			printer::reportRuntimeError(noSuchPizza(*ps.session, pspec), ps);
 			return 1;
 		}
 
@@ -251,16 +716,21 @@ int AlterPizzaSetCrust::execute(ProgramState& ps)
 	return 0;
 }
 
-int AlterPizzaSetSauce::execute(ProgramState& ps)
+int run::alterPizzaSetSauce(ProgramState& ps, const PizzaSpecifier& pspec, Sauce s)
 {
 	if (ps.session) {
 
-		if (std::visit([&](auto&& arg) { return ps.session->located(arg); }, pspec)) {
-			Pizza& pz = std::visit([&](auto&& arg) -> Pizza& { return ps.session->locate(arg).pizza; }, pspec);
+		auto slot = std::visit([&](auto&& arg) { return ps.session->locate(arg); }, pspec);
+		if (slot != OrderSession::npos) {
+			Pizza pz = ps.session->pizza(slot);
+			ps.logUndo([id = ps.session->ids[slot], old = ps.session->pizza(slot)](ProgramState& ps) { 
+				ps.session->setPizza(ps.session->locate(id), old); 
+			});
 			pz.sauce = s;
+			ps.session->setPizza(slot, pz);
 			return 0;
 		} else {
-			printer::reportRuntimeError("Error: No such pizza has been ordered.", ps);
+			printer::reportRuntimeError(noSuchPizza(*ps.session, pspec), ps);
 			return 1;
 		}
 
@@ -272,16 +742,45 @@ int AlterPizzaSetSauce::execute(ProgramState& ps)
 	return 0;
 }
 
-int AlterPizzaSetCheese::execute(ProgramState& ps)
+int run::alterPizzaSetCheese(ProgramState& ps, const PizzaSpecifier& pspec, Cheese ch)
 {
 	if (ps.session) {
 
-		if (std::visit([&](auto&& arg) { return ps.session->located(arg); }, pspec)) {
-			Pizza& pz = std::visit([&](auto&& arg) -> Pizza& { return ps.session->locate(arg).pizza; }, pspec);
+		auto slot = std::visit([&](auto&& arg) { return ps.session->locate(arg); }, pspec);
+		if (slot != OrderSession::npos) {
+			Pizza pz = ps.session->pizza(slot);
+			ps.logUndo([id = ps.session->ids[slot], old = ps.session->pizza(slot)](ProgramState& ps) { 
+				ps.session->setPizza(ps.session->locate(id), old); 
+			});
 			pz.cheese = ch;
+			ps.session->setPizza(slot, pz);
+			return 0;
+		} else {
+			printer::reportRuntimeError(noSuchPizza(*ps.session, pspec), ps);
+			return 1;
+		}
+
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+
+	return 0;
+}
+
+int run::alterPizzaSetName(ProgramState& ps, const PizzaSpecifier& pspec, Symbol name)
+{
+	if (ps.session) {
+
+		auto slot = std::visit([&](auto&& arg) { return ps.session->locate(arg); }, pspec);
+		if (slot != OrderSession::npos) {
+			ps.logUndo([id = ps.session->ids[slot], old = ps.session->names[slot]](ProgramState& ps) { 
+				ps.session->renameOrder(ps.session->locate(id), old); 
+			});
+			ps.session->renameOrder(slot, name);
 			return 0;
 		} else {
-			printer::reportRuntimeError("Error: No such pizza has been ordered.", ps);
+			printer::reportRuntimeError(noSuchPizza(*ps.session, pspec), ps);
 			return 1;
 		}
 
@@ -293,21 +792,229 @@ int AlterPizzaSetCheese::execute(ProgramState& ps)
 	return 0;
 }
 
-int Quit::execute(ProgramState& ps)
+int run::alterPizzaWhere(ProgramState& ps, const Filter& where, const PizzaElement& change, bool removing)
+{
+	if (ps.session) {
+
+		auto alter = [&](Pizza& pz) { // Returns false if the pizza is already as it should be
+			if (std::holds_alternative<ToppingArrangement>(change)) {
+				ToppingArrangement ta = std::get<ToppingArrangement>(change);
+				return removing ? pz.toppings.erase(ta) : pz.toppings.insert(ta);
+			} else if (std::holds_alternative<Crust>(change)) {
+				return std::exchange(pz.crust, std::get<Crust>(change)) != std::get<Crust>(change);
+			} else if (std::holds_alternative<Sauce>(change)) {
+				return std::exchange(pz.sauce, std::get<Sauce>(change)) != std::get<Sauce>(change);
+			} else {
+				return std::exchange(pz.cheese, std::get<Cheese>(change)) != std::get<Cheese>(change);
+			}
+		};
+
+		if (where.onVotes() && !exactVotes(ps)) return 1;
+		SlotSet chosen = where.select(*ps.session);
+		if (ps.undolog && !chosen.empty()) { // (likewise)
+			auto before = std::make_shared<OrderSession>(*ps.session);
+			ps.logUndo([before](ProgramState& ps) { *ps.session = std::move(*before); });
+		}
+		ps.session->setPizzas(chosen, alter);
+		return 0;
+
+	} else {
+		printer::reportRuntimeError("Error: No session active.", ps);
+		return 1;
+	}
+}
+
+int run::beginTransaction(ProgramState& ps)
+{
+	if (ps.undolog) {
+		printer::reportRuntimeError("Error: A transaction is already open.", ps);
+		return 1;
+	} else {
+		ps.beginTransaction();
+		return 0;
+	}
+}
+
+int run::commitTransaction(ProgramState& ps)
+{
+	if (ps.undolog) {
+		ps.commitTransaction();
+		return 0;
+	} else {
+		printer::reportRuntimeError("Error: No transaction is open.", ps);
+		return 1;
+	}
+}
+
+int run::rollbackTransaction(ProgramState& ps)
+{
+	if (ps.undolog) {
+		ps.rollbackTransaction();
+		return 0;
+	} else {
+		printer::reportRuntimeError("Error: No transaction is open.", ps);
+		return 1;
+	}
+}
+
+static bool importsItself(ProgramState& ps, const std::string& filepath, const std::string& path) // Reports it, if so
+{
+	if (std::find(ps.imports.begin(), ps.imports.end(), path) == ps.imports.end()) return false;
+	printer::reportRuntimeError("Error: \"" + filepath + "\" imports itself.", ps);
+	return true;
+}
+
+int run::importScript(ProgramState& ps, const std::string& filepath)
+{
+	std::string path = modules::canonicalPath(filepath);
+	if (path.empty()) {
+		printer::reportRuntimeError("Error: File \"" + filepath + "\" does not exist.", ps);
+		return 1;
+	} else if (importsItself(ps, filepath, path)) {
+		return 1;
+	}
+
+	std::shared_ptr<Program> module;
+	try {
+		module = modules::load(path);
+	} catch (BadInterp& bi) {
+		printer::reportRuntimeError("Error: Could not interpret \"" + filepath + "\".", ps);
+		printer::reportInterpError(bi, ps);
+		return 1;
+	}
+
+	return importModule(ps, filepath, path, [&module](ProgramState& ps, std::size_t& reached) {
+		return executeNested(*module, ps, reached);
+	});
+}
+
+int run::importModule(ProgramState& ps, const std::string& filepath, const std::string& path, const Body& module)
+{
+	if (importsItself(ps, filepath, path)) return 1;
+
+	ps.imports.push_back(path);
+	std::size_t reached = 0;
+	int err_code = module(ps, reached);
+	ps.imports.pop_back();
+
+	if (err_code) {
+		printer::reportRuntimeError("Error: Halted at statement #" + std::to_string(reached) + " of \"" + filepath + "\".", ps);
+	}
+	return err_code;
+}
+
+int run::repeatBlock(ProgramState& ps, int n, const Body& body)
+{
+	if (n < 0) {
+		printer::reportRuntimeError("Error: Cannot repeat a block a negative number of times.", ps);
+		return 1;
+	}
+
+	for (int i = 1; i <= n; ++i) {
+		std::size_t reached = 0;
+		if (int err_code = body(ps, reached)) {
+			printer::reportRuntimeError("Error: Halted at statement #" + std::to_string(reached) + " of the block, on repetition #" + std::to_string(i) + ".", ps);
+			return err_code;
+		}
+	}
+	return 0;
+}
+
+int run::quit(ProgramState& ps)
 {
 	ps.running = false;
 	return 0;
 }
 
-int execute(Program& p, ProgramState& ps)
+template<typename F>
+static int runProgram(ProgramState& ps, F statements) // statements runs the program's statements in turn, halting on error
 {
 	printer::lineBreak();
+	bool implicit_transaction = ps.atomic && !ps.undolog; // In atomic mode, the whole program is its own transaction
+	if (implicit_transaction) ps.beginTransaction();
+
+	int err_code = statements();
+
+	if (err_code && ps.undolog) { // An error inside a transaction undoes everything since it began
+		ps.rollbackTransaction();
+		printer::reportRollback();
+	} else if (implicit_transaction && ps.undolog) {
+		ps.commitTransaction();
+	}
+	return err_code;
+}
+
+int execute(Program& p, ProgramState& ps)
+{
+	return runProgram(ps, [&]() {
+		ps.programcounter = 1;
+		for (const auto& s : p) { // Iterate over program and execute statements, halting on error
+			if (!s) continue; // This is just in case someone tries to run a (logically) deleted program
+			if (int err_code = s->execute(ps)) return err_code; // execute the statement and stop if the error code is nonzero
+			++ps.programcounter;
+		}
+		return 0;
+	});
+}
+
+int execute(int (*script)(ProgramState&), ProgramState& ps)
+{
+	return runProgram(ps, [&]() { return script(ps); });
+}
+
+int executeNested(Program& p, ProgramState& ps, std::size_t& reached)
+{
 	int err_code = 0;
-	ps.programcounter = 1;
-	for (const auto& s : p) { // Iterate over program and execute statements, halting on error
-		if (!s) continue; // This is just in case someone tries to run a (logically) deleted program
-		if ((err_code = s->execute(ps))) break; // execute the statement and terminate the loop if the error code is nonzero
-		++ps.programcounter;
+	reached = 0;
+	for (const auto& s : p) { // Like execute, but the program counter keeps pointing at the enclosing statement
+		++reached;
+		if (!s) continue;
+		if ((err_code = s->execute(ps))) break;
 	}
 	return err_code;
 }
+
+/* Statements */
+
+int StartSession::execute(ProgramState& ps) { return run::startSession(ps, name, reserves, approximate); }
+int NameSession::execute(ProgramState& ps) { return run::nameSession(ps, name); }
+int EndSession::execute(ProgramState& ps) { return run::endSession(ps); }
+int SaveSession::execute(ProgramState& ps) { return run::saveSession(ps, filepath); }
+int LoadSession::execute(ProgramState& ps) { return run::loadSession(ps, filepath); }
+int MergeSession::execute(ProgramState& ps) { return run::mergeSession(ps, filepath); }
+int AddPizza::execute(ProgramState& ps) { return run::addPizza(ps, p, written, name); }
+int RemovePizza::execute(ProgramState& ps) { return run::removePizza(ps, pspec); }
+int RemovePizzaWhere::execute(ProgramState& ps) { return run::removePizzaWhere(ps, where); }
+int ViewPizza::execute(ProgramState& ps) { return run::viewPizza(ps, pspec, details, all); }
+int ViewPizzaWithTopping::execute(ProgramState& ps) { return run::viewPizzaWithTopping(ps, ta, details); }
+int ViewPizzaNearest::execute(ProgramState& ps) { return run::viewPizzaNearest(ps, p, n, details); }
+int ViewPizzaWhere::execute(ProgramState& ps) { return run::viewPizzaWhere(ps, where, details); }
+int ViewPizzaLike::execute(ProgramState& ps) { return run::viewPizzaLike(ps, pattern, details); }
+int VotePizza::execute(ProgramState& ps) { return run::votePizza(ps, pspec, n, voter); }
+int VotePizzas::execute(ProgramState& ps) { return run::votePizzas(ps, votes); }
+int VotePizzaWhere::execute(ProgramState& ps) { return run::votePizzaWhere(ps, where, n); }
+int CastBallot::execute(ProgramState& ps) { return run::castBallot(ps, prefs, ranked); }
+int SelectTopPizza::execute(ProgramState& ps) { return run::selectTopPizza(ps, n); }
+int SelectTopPizzaWhere::execute(ProgramState& ps) { return run::selectTopPizzaWhere(ps, n, where); }
+int SelectTopPizzaBy::execute(ProgramState& ps) { return run::selectTopPizzaBy(ps, n, how); }
+int AggregateIngredients::execute(ProgramState& ps) { return run::aggregateIngredients(ps, n, all, by_votes); }
+int ResetSessionVotes::execute(ProgramState& ps) { return run::resetSessionVotes(ps); }
+int ResetSession::execute(ProgramState& ps) { return run::resetSession(ps); }
+int AlterPizzaAdd::execute(ProgramState& ps) { return run::alterPizzaAdd(ps, pspec, ta); }
+int AlterPizzaRemove::execute(ProgramState& ps) { return run::alterPizzaRemove(ps, pspec, ta); }
+int AlterPizzaSetCrust::execute(ProgramState& ps) { return run::alterPizzaSetCrust(ps, pspec, c); }
+int AlterPizzaSetSauce::execute(ProgramState& ps) { return run::alterPizzaSetSauce(ps, pspec, s); }
+int AlterPizzaSetCheese::execute(ProgramState& ps) { return run::alterPizzaSetCheese(ps, pspec, ch); }
+int AlterPizzaSetName::execute(ProgramState& ps) { return run::alterPizzaSetName(ps, pspec, name); }
+int AlterPizzaWhere::execute(ProgramState& ps) { return run::alterPizzaWhere(ps, where, change, removing); }
+int BeginTransaction::execute(ProgramState& ps) { return run::beginTransaction(ps); }
+int CommitTransaction::execute(ProgramState& ps) { return run::commitTransaction(ps); }
+int RollbackTransaction::execute(ProgramState& ps) { return run::rollbackTransaction(ps); }
+int ImportScript::execute(ProgramState& ps) { return run::importScript(ps, filepath); }
+
+int RepeatBlock::execute(ProgramState& ps)
+{
+	return run::repeatBlock(ps, n, [this](ProgramState& ps, std::size_t& reached) { return executeNested(*body, ps, reached); });
+}
+
+int Quit::execute(ProgramState& ps) { return run::quit(ps); }
@@ -0,0 +1,62 @@
+#include "suffixindex.hpp"
+#include <unordered_set>
+
+void SuffixIndex::insert(Symbol name)
+{
+	std::string_view text = name.text();
+	for (std::size_t i = 0; i < text.size(); ++i) suffixes.emplace(text.substr(i), name.id);
+}
+
+void SuffixIndex::erase(Symbol name)
+{
+	std::string_view text = name.text();
+	for (std::size_t i = 0; i < text.size(); ++i) suffixes.erase({text.substr(i), name.id});
+}
+
+void SuffixIndex::clear() { suffixes.clear(); }
+
+std::vector<Symbol> SuffixIndex::like(std::string_view pattern) const
+{
+	// Every match contains the longest run of plain characters in the pattern, so only the names with it need checking
+	std::string_view key;
+	bool anchored = false; // whether the key has to be at the very start of the name
+	for (std::size_t begin = 0; begin <= pattern.size();) {
+		std::size_t end = pattern.find_first_of("%_", begin);
+		if (end == std::string_view::npos) end = pattern.size();
+		if (end - begin > key.size()) {
+			key = pattern.substr(begin, end - begin);
+			anchored = (begin == 0);
+		}
+		begin = end + 1;
+	}
+
+	std::vector<Symbol> found;
+	std::unordered_set<std::uint32_t> seen; // (a name can contain the key more than once)
+	for (auto s = suffixes.lower_bound({key, 0}); s != suffixes.end() && s->first.substr(0, key.size()) == key; ++s) {
+		Symbol name{s->second};
+		if (anchored && s->first.size() != name.text().size()) continue;
+		if (seen.insert(name.id).second && matches(name.text(), pattern)) found.push_back(name);
+	}
+	return found;
+}
+
+bool SuffixIndex::matches(std::string_view text, std::string_view pattern)
+{
+	std::size_t t = 0, p = 0;
+	std::size_t star = std::string_view::npos, resume = 0; // where the last '%' was, and where its match would end
+	while (t < text.size()) {
+		if (p < pattern.size() && (pattern[p] == '_' || pattern[p] == text[t])) {
+			++t, ++p;
+		} else if (p < pattern.size() && pattern[p] == '%') {
+			star = p++;
+			resume = t;
+		} else if (star != std::string_view::npos) { // let the last '%' swallow one more character, and try again from there
+			p = star + 1;
+			t = ++resume;
+		} else {
+			return false;
+		}
+	}
+	while (p < pattern.size() && pattern[p] == '%') ++p;
+	return p == pattern.size();
+}
@@ -0,0 +1,33 @@
+#include "symbols.hpp"
+#include <deque>
+#include <unordered_map>
+
+namespace {
+
+	struct SymbolTable
+	{
+		std::deque<std::string> texts{""}; // A deque, so the views in ids stay valid as it grows
+		std::unordered_map<std::string_view, std::uint32_t> ids{{texts.front(), 0}};
+	};
+
+	SymbolTable& table() // Constructed on first use, so symbols can be interned during static initialization
+	{
+		static SymbolTable st;
+		return st;
+	}
+
+}
+
+Symbol Symbol::of(std::string_view text)
+{
+	SymbolTable& st = table();
+	auto found = st.ids.find(text);
+	if (found != st.ids.end()) return Symbol{found->second};
+
+	auto id = static_cast<std::uint32_t>(st.texts.size());
+	st.texts.emplace_back(text);
+	st.ids.emplace(st.texts.back(), id);
+	return Symbol{id};
+}
+
+const std::string& Symbol::text() const { return table().texts[id]; }
@@ -0,0 +1,271 @@
+#include "transpiler.hpp"
+#include "modules.hpp"
+#include "interperrors.hpp"
+#include <cstdio>
+
+std::string transpiler::literal(int i) { return std::to_string(i); }
+std::string transpiler::literal(bool b) { return b ? "true" : "false"; }
+
+std::string transpiler::literal(const std::string& s)
+{
+	std::string lit = "std::string(\"";
+	for (char ch : s) {
+		switch (ch) {
+			case '\\': lit += "\\\\"; break;
+			case '\"': lit += "\\\""; break;
+			case '\n': lit += "\\n"; break;
+			case '\t': lit += "\\t"; break;
+			case '\r': lit += "\\r"; break;
+			default:
+				if (static_cast<unsigned char>(ch) < ' ') { // any other control character is written in octal
+					char esc[5];
+					std::snprintf(esc, sizeof esc, "\\%03o", static_cast<unsigned char>(ch));
+					lit += esc;
+				} else {
+					lit += ch;
+				}
+		}
+	}
+	return lit + "\")";
+}
+
+std::string transpiler::literal(Symbol s) { return "Symbol::of(" + literal(s.text()) + ")"; }
+
+// The enumerators are written as casts, since the translation tables have aliases and don't line up with their names
+
+std::string transpiler::literal(Crust c) { return "static_cast<Crust>(" + std::to_string(static_cast<int>(c)) + ")"; }
+std::string transpiler::literal(Sauce s) { return "static_cast<Sauce>(" + std::to_string(static_cast<int>(s)) + ")"; }
+std::string transpiler::literal(Cheese ch) { return "static_cast<Cheese>(" + std::to_string(static_cast<int>(ch)) + ")"; }
+
+std::string transpiler::literal(ToppingArrangement ta)
+{
+	return "ToppingArrangement{static_cast<ToppingPosition>(" + std::to_string(static_cast<int>(ta.position)) + "), "
+		+ "static_cast<Topping>(" + std::to_string(static_cast<int>(ta.topping)) + ")}";
+}
+
+std::string transpiler::literal(const Pizza& p)
+{
+	std::string lit = "Pizza{" + literal(p.crust) + ", " + literal(p.sauce) + ", " + literal(p.cheese) + ", {";
+	for (auto t = p.toppings.begin(); t != p.toppings.end(); ++t) {
+		lit += literal(*t);
+		if (std::next(t) != p.toppings.end()) lit += ", ";
+	}
+	return lit + "}}";
+}
+
+std::string transpiler::literal(const ToppingOrder& to)
+{
+	std::string lit = "ToppingOrder{";
+	for (auto t = to.begin(); t != to.end(); ++t) {
+		lit += literal(*t);
+		if (std::next(t) != to.end()) lit += ", ";
+	}
+	return lit + "}";
+}
+
+std::string transpiler::literal(const PizzaElement& pze)
+{
+	return "PizzaElement{" + std::visit([](auto&& arg) { return literal(arg); }, pze) + "}";
+}
+
+std::string transpiler::literal(const PizzaSpecifier& pspec)
+{
+	return "PizzaSpecifier{" + std::visit([](auto&& arg) { return literal(arg); }, pspec) + "}";
+}
+
+std::string transpiler::literal(const SpecifierList& sl)
+{
+	std::string lit = "SpecifierList{";
+	for (auto s = sl.begin(); s != sl.end(); ++s) {
+		lit += literal(*s);
+		if (std::next(s) != sl.end()) lit += ", ";
+	}
+	return lit + "}";
+}
+
+std::string transpiler::literal(const VoteList& vl)
+{
+	std::string lit = "VoteList{";
+	for (auto v = vl.begin(); v != vl.end(); ++v) {
+		lit += "{" + literal(v->first) + ", " + literal(v->second) + "}";
+		if (std::next(v) != vl.end()) lit += ", ";
+	}
+	return lit + "}";
+}
+
+std::string transpiler::literal(Tally t) { return "static_cast<Tally>(" + std::to_string(static_cast<int>(t)) + ")"; }
+
+std::string transpiler::literal(const ToppingMask& tm)
+{
+	return "ToppingMask{" + std::to_string(tm[0]) + "ull, " + std::to_string(tm[1]) + "ull}";
+}
+
+std::string transpiler::literal(const Conjunct& c)
+{
+	auto bound = [](std::int64_t v) {
+		if (v == INT64_MIN) return std::string("INT64_MIN"); // (which can't be written as a literal)
+		if (v == INT64_MAX) return std::string("INT64_MAX");
+		return "std::int64_t{" + std::to_string(v) + "}";
+	};
+
+	std::string lit = "Conjunct{" + literal(c.all) + ", " + literal(c.none) + ", " + literal(c.meat) + ", "
+		+ std::to_string(c.crusts) + ", " + std::to_string(c.sauces) + ", " + std::to_string(c.cheeses) + ", "
+		+ bound(c.min_votes) + ", " + bound(c.max_votes) + ", " + (c.name ? literal(*c.name) : "std::nullopt") + ", {";
+	for (auto s = c.not_names.begin(); s != c.not_names.end(); ++s) {
+		lit += literal(*s);
+		if (std::next(s) != c.not_names.end()) lit += ", ";
+	}
+	return lit + "}, " + literal(c.never) + "}";
+}
+
+std::string transpiler::literal(const Filter& f)
+{
+	std::string lit = "Filter{{";
+	for (auto c = f.conjuncts.begin(); c != f.conjuncts.end(); ++c) {
+		lit += literal(*c);
+		if (std::next(c) != f.conjuncts.end()) lit += ", ";
+	}
+	return lit + "}}";
+}
+
+std::string transpiler::Unit::constant(const std::string& type, const std::string& value)
+{
+	Function& f = writing.back();
+	auto [named, added] = f.named.try_emplace({type, value}, "k" + std::to_string(f.named.size()));
+	if (added) f.constants += "\tstatic const " + type + " " + named->second + " = " + value + ";\n";
+	return named->second;
+}
+
+std::string transpiler::Unit::nested(Program& p) { return sequence(p, "block" + std::to_string(functions++), true); }
+
+std::string transpiler::Unit::module(const std::string& path, Program& p)
+{
+	auto [named, added] = modules.try_emplace(path, "module" + std::to_string(functions));
+	if (!added) return named->second;
+	++functions;
+	return sequence(p, named->second, true);
+}
+
+std::string transpiler::Unit::sequence(Program& p, const std::string& name, bool nested)
+{
+	std::string params = nested ? "(ProgramState& ps, std::size_t& reached)" : "(ProgramState& ps)";
+	std::string args = nested ? "(ps, reached)" : "(ps)";
+
+	constexpr std::size_t chunk = 256; // Statements are split over several functions, since compilers handle one huge function poorly
+	std::string parts;
+	int counter = 0; // (the program counter skips empty statements, but reached counts them)
+	for (std::size_t i = 0, n = 0; i < p.size(); i += chunk, ++n) {
+		std::string part = name + "_" + std::to_string(n);
+		writing.push_back(Function{"static int " + part + params, {}, "", ""});
+		for (std::size_t j = i; j < p.size() && j < i + chunk; ++j) {
+			if (!p[j]) continue;
+			std::string call = p[j]->transpile(*this); // (which may write functions of its own, so writing.back() can move)
+			std::string& body = writing.back().body;
+			body += nested ? "\treached = " + std::to_string(j + 1) + ";\n" : "\tps.programcounter = " + std::to_string(++counter) + ";\n";
+			body += "\tif (int err_code = " + call + ") return err_code;\n";
+		}
+		written.push_back(std::move(writing.back()));
+		writing.pop_back();
+		parts += "\tif (int err_code = " + part + args + ") return err_code;\n";
+	}
+
+	written.push_back(Function{"static int " + name + params, {}, "", parts});
+	return name;
+}
+
+void transpiler::Unit::write(Program& p, std::ostream& os, const std::string& origin)
+{
+	sequence(p, "script", false);
+
+	os << "// Generated by plang -emit-cpp from \"" << origin << "\"; do not edit.\n";
+	os << "// Build with: g++ <this file> <every src/*.cpp but main.cpp> -std=c++17 -I include\n\n";
+	os << "#include \"program.hpp\"\n";
+	os << "#include \"printer.hpp\"\n";
+	os << "#include \"transpiler.hpp\"\n\n";
+
+	for (const Function& f : written) os << f.signature << ";\n"; // (blocks and scripts can be run before they're defined)
+	os << "\n";
+	for (const Function& f : written) {
+		os << f.signature << "\n{\n" << f.constants << (f.constants.empty() ? "" : "\n") << f.body << "\treturn 0;\n}\n\n";
+	}
+
+	os << "int main()\n{\n";
+	os << "\tProgramState ps;\n";
+	os << "\tint retcode = execute(script, ps);\n";
+	os << "\tif (retcode) {\n";
+	os << "\t\tprinter::reportError();\n";
+	os << "\t}\n";
+	os << "\treturn retcode;\n";
+	os << "}\n";
+}
+
+void transpiler::emitProgram(Program& p, std::ostream& os, const std::string& origin)
+{
+	Unit u;
+	u.write(p, os, origin);
+}
+
+/* Statements */
+
+using transpiler::literal;
+
+static std::string call(const std::string& function, const std::vector<std::string>& args) // e.g. "run::addPizza(ps, k0, k1)"
+{
+	std::string c = "run::" + function + "(ps";
+	for (const std::string& arg : args) c += ", " + arg;
+	return c + ")";
+}
+
+std::string StartSession::transpile(transpiler::Unit& u) { return call("startSession", {u.constant("Symbol", literal(name)), literal(reserves), literal(approximate)}); }
+std::string NameSession::transpile(transpiler::Unit& u) { return call("nameSession", {u.constant("Symbol", literal(name))}); }
+std::string EndSession::transpile(transpiler::Unit& u) { return call("endSession", {}); }
+std::string SaveSession::transpile(transpiler::Unit& u) { return call("saveSession", {u.constant("std::string", literal(filepath))}); }
+std::string LoadSession::transpile(transpiler::Unit& u) { return call("loadSession", {u.constant("std::string", literal(filepath))}); }
+std::string MergeSession::transpile(transpiler::Unit& u) { return call("mergeSession", {u.constant("std::string", literal(filepath))}); }
+
+std::string AddPizza::transpile(transpiler::Unit& u) { return call("addPizza", {u.constant("Pizza", literal(p)), u.constant("ToppingOrder", literal(written)), u.constant("Symbol", literal(name))}); }
+std::string RemovePizza::transpile(transpiler::Unit& u) { return call("removePizza", {u.constant("PizzaSpecifier", literal(pspec))}); }
+std::string RemovePizzaWhere::transpile(transpiler::Unit& u) { return call("removePizzaWhere", {u.constant("Filter", literal(where))}); }
+std::string ViewPizza::transpile(transpiler::Unit& u) { return call("viewPizza", {u.constant("PizzaSpecifier", literal(pspec)), literal(details), literal(all)}); }
+std::string ViewPizzaWithTopping::transpile(transpiler::Unit& u) { return call("viewPizzaWithTopping", {literal(ta), literal(details)}); }
+std::string ViewPizzaLike::transpile(transpiler::Unit& u) { return call("viewPizzaLike", {u.constant("std::string", literal(pattern)), literal(details)}); }
+std::string ViewPizzaNearest::transpile(transpiler::Unit& u) { return call("viewPizzaNearest", {u.constant("Pizza", literal(p)), literal(n), literal(details)}); }
+std::string ViewPizzaWhere::transpile(transpiler::Unit& u) { return call("viewPizzaWhere", {u.constant("Filter", literal(where)), literal(details)}); }
+std::string VotePizza::transpile(transpiler::Unit& u) { return call("votePizza", {u.constant("PizzaSpecifier", literal(pspec)), literal(n), u.constant("Symbol", literal(voter))}); }
+std::string VotePizzas::transpile(transpiler::Unit& u) { return call("votePizzas", {u.constant("VoteList", literal(votes))}); }
+std::string VotePizzaWhere::transpile(transpiler::Unit& u) { return call("votePizzaWhere", {u.constant("Filter", literal(where)), literal(n)}); }
+std::string CastBallot::transpile(transpiler::Unit& u) { return call("castBallot", {u.constant("SpecifierList", literal(prefs)), literal(ranked)}); }
+std::string SelectTopPizza::transpile(transpiler::Unit& u) { return call("selectTopPizza", {literal(n)}); }
+std::string SelectTopPizzaWhere::transpile(transpiler::Unit& u) { return call("selectTopPizzaWhere", {literal(n), u.constant("Filter", literal(where))}); }
+std::string SelectTopPizzaBy::transpile(transpiler::Unit& u) { return call("selectTopPizzaBy", {literal(n), literal(how)}); }
+std::string AggregateIngredients::transpile(transpiler::Unit& u) { return call("aggregateIngredients", {literal(n), literal(all), literal(by_votes)}); }
+std::string ResetSessionVotes::transpile(transpiler::Unit& u) { return call("resetSessionVotes", {}); }
+std::string ResetSession::transpile(transpiler::Unit& u) { return call("resetSession", {}); }
+
+std::string AlterPizzaAdd::transpile(transpiler::Unit& u) { return call("alterPizzaAdd", {u.constant("PizzaSpecifier", literal(pspec)), literal(ta)}); }
+std::string AlterPizzaRemove::transpile(transpiler::Unit& u) { return call("alterPizzaRemove", {u.constant("PizzaSpecifier", literal(pspec)), literal(ta)}); }
+std::string AlterPizzaSetCrust::transpile(transpiler::Unit& u) { return call("alterPizzaSetCrust", {u.constant("PizzaSpecifier", literal(pspec)), literal(c)}); }
+std::string AlterPizzaSetSauce::transpile(transpiler::Unit& u) { return call("alterPizzaSetSauce", {u.constant("PizzaSpecifier", literal(pspec)), literal(s)}); }
+std::string AlterPizzaSetCheese::transpile(transpiler::Unit& u) { return call("alterPizzaSetCheese", {u.constant("PizzaSpecifier", literal(pspec)), literal(ch)}); }
+std::string AlterPizzaSetName::transpile(transpiler::Unit& u) { return call("alterPizzaSetName", {u.constant("PizzaSpecifier", literal(pspec)), u.constant("Symbol", literal(name))}); }
+std::string AlterPizzaWhere::transpile(transpiler::Unit& u) { return call("alterPizzaWhere", {u.constant("Filter", literal(where)), u.constant("PizzaElement", literal(change)), literal(removing)}); }
+
+std::string BeginTransaction::transpile(transpiler::Unit& u) { return call("beginTransaction", {}); }
+std::string CommitTransaction::transpile(transpiler::Unit& u) { return call("commitTransaction", {}); }
+std::string RollbackTransaction::transpile(transpiler::Unit& u) { return call("rollbackTransaction", {}); }
+
+std::string ImportScript::transpile(transpiler::Unit& u) // The script is read in now, if it can be; if not, it's left to be
+{                                                         // imported when the program runs, which reports why it can't be
+	std::string path = modules::canonicalPath(filepath);
+	std::shared_ptr<Program> module;
+	try {
+		if (!path.empty()) module = modules::load(path);
+	} catch (BadInterp&) {}
+
+	if (!module) return call("importScript", {u.constant("std::string", literal(filepath))});
+	return call("importModule", {u.constant("std::string", literal(filepath)), u.constant("std::string", literal(path)),
+		u.constant("run::Body", u.module(path, *module))});
+}
+
+std::string RepeatBlock::transpile(transpiler::Unit& u) { return call("repeatBlock", {literal(n), u.constant("run::Body", u.nested(*body))}); }
+std::string Quit::transpile(transpiler::Unit& u) { return call("quit", {}); }
@@ -0,0 +1,54 @@
+#include "voters.hpp"
+#include "pizza.hpp"
+
+std::size_t VoterTable::home(Symbol voter) const // Fibonacci hashing, which spreads out the consecutive IDs symbols get
+{
+	return static_cast<std::size_t>((voter.id * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+}
+
+VoterTable::Entry& VoterTable::operator[](Symbol voter)
+{
+	if (2 * (used + 1) > entries.size()) grow();
+	for (std::size_t i = home(voter);; i = (i + 1) & (entries.size() - 1)) {
+		if (entries[i].voter == voter) return entries[i];
+		if (entries[i].voter.empty()) {
+			++used;
+			entries[i].voter = voter;
+			return entries[i];
+		}
+	}
+}
+
+const VoterTable::Entry* VoterTable::find(Symbol voter) const
+{
+	if (entries.empty()) return nullptr;
+	for (std::size_t i = home(voter);; i = (i + 1) & (entries.size() - 1)) {
+		if (entries[i].voter == voter) return &entries[i];
+		if (entries[i].voter.empty()) return nullptr;
+	}
+}
+
+std::size_t VoterTable::size() const
+{
+	return used;
+}
+
+void VoterTable::clear()
+{
+	entries.clear();
+	used = 0;
+	bits = 0;
+}
+
+void VoterTable::grow()
+{
+	std::vector<Entry> old(entries.empty() ? 16 : 2 * entries.size());
+	old.swap(entries);
+	bits = lowestBit(entries.size()); // (a power of two, so its lowest bit is its logarithm)
+	for (const Entry& e : old) {
+		if (e.voter.empty()) continue;
+		std::size_t i = home(e.voter);
+		while (!entries[i].voter.empty()) i = (i + 1) & (entries.size() - 1);
+		entries[i] = e;
+	}
+}